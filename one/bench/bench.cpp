@@ -0,0 +1,333 @@
+#include "curve.h"
+#include "surf.h"
+
+#include <vecmath.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+#ifdef VECMATH_HEADER_ONLY
+const char *kMode = "header-only";
+#else
+const char *kMode = "libvecmath.a";
+#endif
+
+// Runs fn() until at least minSeconds have passed and reports the best
+// time per item over all repetitions.  fn returns the number of items
+// (points, vertices, ...) it produced.
+template <typename F>
+void run(const char *name, F fn, double minSeconds = 0.5) {
+    using clock = chrono::steady_clock;
+
+    double best = 1e30;
+    size_t items = 0;
+    auto start = clock::now();
+
+    do {
+        auto t0 = clock::now();
+        items = fn();
+        auto t1 = clock::now();
+        best = min(best, chrono::duration<double, nano>(t1 - t0).count());
+    } while (chrono::duration<double>(clock::now() - start).count() <
+             minSeconds);
+
+    printf("%-30s %-14s %10zu items %9.2f ns/item\n", name, kMode, items,
+           best / items);
+}
+
+vector<Vector3f> bezierControlPoints() {
+    return {
+        {0, 0, 0}, {1, 2, 0},  {2, -1, 1}, {3, 0, 0},
+        {4, 1, 1}, {5, -2, 0}, {6, 0, 0},
+    };
+}
+
+vector<Vector3f> bsplineControlPoints() {
+    return {
+        {1, 0, 0}, {0, 1, 0}, {-1, 0, 0}, {0, -1, 0},
+        {1, 0, 0}, {0, 1, 0}, {-1, 0, 0},
+    };
+}
+
+// makeGenCyl's vertex loop as it was written against Matrix4f, kept to
+// compare with the Affine3f version in surf.cpp.
+size_t genCylMatrix4f(const Curve &profile, const Curve &sweep,
+                      vector<Vector3f> &VV, vector<Vector3f> &VN) {
+    vector<Vector3f> V, N;
+    for (auto &p : profile) {
+        V.push_back(p.V);
+        N.push_back(-p.N);
+    }
+
+    const size_t ring = profile.size();
+    VV.resize(sweep.size() * ring);
+    VN.resize(sweep.size() * ring);
+
+    for (size_t u = 0; u < sweep.size(); u++) {
+        Matrix4f coord{
+            {sweep[u].N, 0},
+            {sweep[u].B, 0},
+            {sweep[u].T, 0},
+            {sweep[u].V, 1},
+        };
+        auto normalRotation =
+            coord.getSubmatrix3x3(0, 0).transposed().inverse();
+
+        transformPoints(coord, V.data(), &VV[u * ring], ring);
+        transform(normalRotation, N.data(), &VN[u * ring], ring);
+    }
+    return VV.size();
+}
+
+size_t genCylAffine3f(const Curve &profile, const Curve &sweep,
+                      vector<Vector3f> &VV, vector<Vector3f> &VN) {
+    vector<Vector3f> V, N;
+    for (auto &p : profile) {
+        V.push_back(p.V);
+        N.push_back(-p.N);
+    }
+
+    const size_t ring = profile.size();
+    VV.resize(sweep.size() * ring);
+    VN.resize(sweep.size() * ring);
+
+    for (size_t u = 0; u < sweep.size(); u++) {
+        Affine3f frame(sweep[u].N, sweep[u].B, sweep[u].T, sweep[u].V);
+
+        transformPoints(frame, V.data(), &VV[u * ring], ring);
+        transform(frame.normalMatrix(), N.data(), &VN[u * ring], ring);
+    }
+    return VV.size();
+}
+
+// Per-frame matrix operations only, to isolate them from the vertex work.
+template <typename T> size_t composeAll(const vector<T> &frames, T &sink) {
+    T acc = frames[0];
+    for (size_t i = 1; i < frames.size(); ++i) {
+        acc = acc * frames[i];
+    }
+    sink = acc;
+    return frames.size();
+}
+
+size_t invertAll(const vector<Matrix4f> &frames, float &sink) {
+    for (auto &m : frames) {
+        sink += m.inverse()(0, 3);
+    }
+    return frames.size();
+}
+
+size_t invertAll(const vector<Affine3f> &frames, float &sink, bool rigid) {
+    for (auto &a : frames) {
+        sink += (rigid ? a.rigidInverse() : a.inverse()).getTranslation()[0];
+    }
+    return frames.size();
+}
+
+} // namespace
+
+int main() {
+    // evalBezier/evalBspline log their input to cerr
+    cerr.setstate(ios::badbit);
+
+    auto bezier = bezierControlPoints();
+    run("evalBezier (steps=20000)",
+        [&] { return evalBezier(bezier, 20000).size(); });
+
+    auto bspline = bsplineControlPoints();
+    run("evalBspline (steps=5000)",
+        [&] { return evalBspline(bspline, 5000).size(); });
+    run("evalBsplineFrames (steps=5000)",
+        [&] { return evalBsplineFrames(bspline, 5000).size(); });
+
+    // a closed, non-planar B-spline, which needs the closure twist
+    vector<Vector3f> knot;
+    for (int i = 0; i < 12; ++i) {
+        float a = 2 * M_PI * (i % 9) / 9;
+        knot.emplace_back(cos(a) + 2 * cos(2 * a), sin(a) - 2 * sin(2 * a),
+                          1.5f * sin(3 * a));
+    }
+    run("evalBspline knot (steps=5000)",
+        [&] { return evalBspline(knot, 5000).size(); });
+    run("evalBsplineFrames knot",
+        [&] { return evalBsplineFrames(knot, 5000).size(); });
+
+    // FRAMES_FLOAT against FRAMES_DOUBLE: the time, and how far the float
+    // carry drifts from the double one on an open curve (closing it would
+    // spread the drift into the twist)
+    run("evalBspline float frames",
+        [&] { return evalBspline(bspline, 5000, FRAMES_FLOAT).size(); });
+    run("evalBspline double frames",
+        [&] { return evalBspline(bspline, 5000, FRAMES_DOUBLE).size(); });
+    vector<Vector3f> openKnot(knot.begin(), knot.end() - 1);
+    for (unsigned steps : {1000u, 100000u}) {
+        auto floatFrames = evalBspline(openKnot, steps, FRAMES_FLOAT);
+        auto doubleFrames = evalBspline(openKnot, steps, FRAMES_DOUBLE);
+        float drift = 0;
+        for (size_t i = 0; i < floatFrames.size(); ++i) {
+            drift = max(drift, (floatFrames[i].N - doubleFrames[i].N).abs());
+        }
+        printf("%-30s %-14s %10zu items %9.2g max |dN|\n",
+               "float frame drift", kMode, floatFrames.size(), drift);
+    }
+
+    auto profile = evalCircle(0.2f, 64);
+    for (auto &p : profile) {
+        p.V = p.V + Vector3f(1, 0, 0);
+    }
+
+    auto sweep = evalBspline(bspline, 4000);
+    run("makeGenCyl (16000 x 65)",
+        [&] { return makeGenCyl(profile, sweep).VV.size(); });
+    auto frameSweep = evalBsplineFrames(bspline, 4000);
+    run("makeGenCyl FrameCurve",
+        [&] { return makeGenCyl(profile, frameSweep).VV.size(); });
+
+    // Matrix4f vs Affine3f on large sweeps
+    vector<Vector3f> VV, VN;
+    for (unsigned steps : {4000u, 40000u}) {
+        auto bigSweep = evalBspline(bspline, steps);
+        char name[64];
+        snprintf(name, sizeof(name), "genCyl Matrix4f (%zu)", bigSweep.size());
+        run(name, [&] { return genCylMatrix4f(profile, bigSweep, VV, VN); });
+        snprintf(name, sizeof(name), "genCyl Affine3f (%zu)", bigSweep.size());
+        run(name, [&] { return genCylAffine3f(profile, bigSweep, VV, VN); });
+    }
+
+    vector<Matrix4f> matrices;
+    vector<Affine3f> affines;
+    for (auto &p : sweep) {
+        affines.emplace_back(p.N, p.B, p.T, p.V);
+        matrices.push_back(affines.back().toMatrix4f());
+    }
+    Matrix4f matrixSink;
+    Affine3f affineSink;
+    float sink = 0;
+    run("compose Matrix4f", [&] { return composeAll(matrices, matrixSink); });
+    run("compose Affine3f", [&] { return composeAll(affines, affineSink); });
+    run("inverse Matrix4f", [&] { return invertAll(matrices, sink); });
+    run("inverse Affine3f",
+        [&] { return invertAll(affines, sink, false); });
+    run("rigidInverse Affine3f",
+        [&] { return invertAll(affines, sink, true); });
+
+    run("normalMatrix cofactor", [&] {
+        for (auto &a : affines) {
+            sink += a.normalMatrix()(0, 0);
+        }
+        return affines.size();
+    });
+    run("normalMatrix orthonormal", [&] {
+        for (auto &a : affines) {
+            sink += a.getLinear().inverseTransposeOrthonormal()(0, 0);
+        }
+        return affines.size();
+    });
+
+    // whole-array normalize: per-element, in place on the Vector3f buffer
+    // through a view, and on SoA lanes
+    vector<Vector3f> normals = makeGenCyl(profile, sweep).VN;
+    Vec3Array normalsSoA(Vec3View(normals.data(), normals.size()));
+    vector<Vector3f> out(normals.size());
+    run("normalize Vector3f", [&] {
+        for (size_t i = 0; i < normals.size(); ++i) {
+            out[i] = normals[i].normalized();
+        }
+        return normals.size();
+    });
+    run("normalize Vec3View (AoS)", [&] {
+        normalize(Vec3View(normals.data(), normals.size()),
+                  Vec3View(out.data(), out.size()));
+        return normals.size();
+    });
+    run("normalize Vec3Array (SoA)", [&] {
+        normalize(normalsSoA, normalsSoA);
+        return normalsSoA.size();
+    });
+
+    // drawNormals: the end point of every normal line
+    Surface cyl = makeGenCyl(profile, sweep);
+    vector<Vector3f> ends(cyl.VV.size());
+    const float len = 0.1f;
+    run("normal ends: operators", [&] {
+        for (size_t i = 0; i < cyl.VV.size(); ++i) {
+            ends[i] = cyl.VV[i] + cyl.VN[i] * len;
+        }
+        return cyl.VV.size();
+    });
+    run("normal ends: Vector3f::madd", [&] {
+        for (size_t i = 0; i < cyl.VV.size(); ++i) {
+            ends[i] = Vector3f::madd(cyl.VN[i], len, cyl.VV[i]);
+        }
+        return cyl.VV.size();
+    });
+    run("normal ends: madd (array)", [&] {
+        madd(Vec3View(cyl.VN.data(), cyl.VN.size()), len,
+             Vec3View(cyl.VV.data(), cyl.VV.size()),
+             Vec3View(ends.data(), ends.size()));
+        return cyl.VV.size();
+    });
+
+    // makeGenCyl's per-vertex frame transform, one vertex at a time
+    vector<Vector3f> ring;
+    for (auto &p : profile) {
+        ring.push_back(p.V);
+    }
+    auto frameLoop = [&](auto transform) {
+        size_t k = 0;
+        for (auto &p : sweep) {
+            Matrix4f coord{{p.N, 0}, {p.B, 0}, {p.T, 0}, {p.V, 1}};
+            for (auto &v : ring) {
+                ends[k++] = transform(coord, v);
+            }
+        }
+        return k;
+    };
+    run("genCyl vertex: operators", [&] {
+        return frameLoop([](const Matrix4f &m, const Vector3f &v) {
+            return (m * Vector4f{v, 1}).xyz();
+        });
+    });
+    run("genCyl vertex: transformPoint", [&] {
+        return frameLoop([](const Matrix4f &m, const Vector3f &v) {
+            return m.transformPoint(v);
+        });
+    });
+
+    run("makeSurfRev (4000 x 65)",
+        [&] { return makeSurfRev(profile, 4000).VV.size(); });
+
+    // optimizeSurface on the generalized cylinder: the vertex cache
+    // statistics of makeGenCyl's order and the optimized one
+    Surface optimized = cyl;
+    optimizeSurface(&optimized);
+    for (unsigned cacheSize : {16u, 32u}) {
+        VertexCacheStats before = analyzeSurface(cyl, cacheSize);
+        VertexCacheStats after = analyzeSurface(optimized, cacheSize);
+        char name[64];
+        snprintf(name, sizeof(name), "genCyl FIFO %u", cacheSize);
+        printf("%-30s %-14s %10zu items ACMR %.3f -> %.3f, ATVR %.3f -> "
+               "%.3f\n",
+               name, kMode, cyl.VF.size(), before.acmr, after.acmr,
+               before.atvr, after.atvr);
+    }
+    run("optimizeSurface", [&] {
+        Surface copy = cyl;
+        optimizeSurface(&copy);
+        return copy.VF.size();
+    });
+
+    // keep the sinks alive
+    if (sink == 1234.5f && matrixSink(0, 0) == affineSink.getLinear()(0, 0)) {
+        printf("\n");
+    }
+
+    return 0;
+}
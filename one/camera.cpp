@@ -1,6 +1,8 @@
 #include "camera.h"
 
+#include "Mat.h"
 #include "Matrix4f.h"
+#include "Vec.h"
 #include "Vector3f.h"
 #include "extra.h"
 
@@ -88,16 +90,19 @@ void Camera::MouseRelease(int x, int y) {
 }
 
 void Camera::ArcBallRotation(int x, int y) {
-    float sx, sy, sz, ex, ey, ez;
-    float scale;
-    float sl, el;
-    float dotprod;
+    // Computed in double: for small drags the dot product is within a few
+    // float ulp of 1, where acos (and the cross product axis) lose most of
+    // their precision.
+    double sx, sy, sz, ex, ey, ez;
+    double scale;
+    double sl, el;
+    double dotprod;
 
     // find vectors from center of window
-    sx = mStartClick[0] - (mDimensions[0] / 2.f);
-    sy = mStartClick[1] - (mDimensions[1] / 2.f);
-    ex = x - (mDimensions[0] / 2.f);
-    ey = y - (mDimensions[1] / 2.f);
+    sx = mStartClick[0] - (mDimensions[0] / 2.0);
+    sy = mStartClick[1] - (mDimensions[1] / 2.0);
+    ex = x - (mDimensions[0] / 2.0);
+    ey = y - (mDimensions[1] / 2.0);
 
     // invert y coordinates (raster versus device coordinates)
     sy = -sy;
@@ -105,12 +110,12 @@ void Camera::ArcBallRotation(int x, int y) {
 
     // scale by inverse of size of window and magical sqrt2 factor
     if (mDimensions[0] > mDimensions[1]) {
-        scale = (float)mDimensions[1];
+        scale = (double)mDimensions[1];
     } else {
-        scale = (float)mDimensions[0];
+        scale = (double)mDimensions[0];
     }
 
-    scale = 1.f / scale;
+    scale = 1.0 / scale;
 
     sx *= scale;
     sy *= scale;
@@ -121,20 +126,20 @@ void Camera::ArcBallRotation(int x, int y) {
     sl = hypot(sx, sy);
     el = hypot(ex, ey);
 
-    if (sl > 1.f) {
+    if (sl > 1.0) {
         sx /= sl;
         sy /= sl;
         sl = 1.0;
     }
-    if (el > 1.f) {
+    if (el > 1.0) {
         ex /= el;
         ey /= el;
-        el = 1.f;
+        el = 1.0;
     }
 
     // project up to unit sphere - find Z coordinate
-    sz = sqrt(1.0f - sl * sl);
-    ez = sqrt(1.0f - el * el);
+    sz = sqrt(1.0 - sl * sl);
+    ez = sqrt(1.0 - el * el);
 
     // rotate (sx,sy,sz) into (ex,ey,ez)
 
@@ -142,14 +147,13 @@ void Camera::ArcBallRotation(int x, int y) {
     // compute axis from cross product.
     dotprod = sx * ex + sy * ey + sz * ez;
 
-    if (dotprod != 1) {
-        Vector3f axis(sy * ez - ey * sz, sz * ex - ez * sx, sx * ey - ex * sy);
-        axis.normalize();
+    if (dotprod < 1) {
+        Vec3d axis(sy * ez - ey * sz, sz * ex - ez * sx, sx * ey - ex * sy);
 
-        float angle = 2.0f * acos(dotprod);
+        double angle = 2.0 * acos(dotprod);
 
-        mCurrentRot = Matrix4f::rotation(axis, angle);
-        mCurrentRot = mCurrentRot * mStartRot;
+        mCurrentRot = toMatrix4f(Mat4d::rotation(axis, angle) *
+                                 toMat<double>(mStartRot));
     } else {
         mCurrentRot = mStartRot;
     }
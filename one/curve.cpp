@@ -1,6 +1,11 @@
 #include "curve.h"
 
+#include "BatchTrig.h"
+#include "Mat.h"
+#include "Matrix3f.h"
 #include "Matrix4f.h"
+#include "Quat4f.h"
+#include "Vec.h"
 #include "Vector3f.h"
 #include "extra.h"
 
@@ -26,24 +31,69 @@ inline bool approx(const Vector3f &lhs, const Vector3f &rhs) {
     return (lhs - rhs).absSquared() < eps;
 }
 
-inline float angle(const Vector3f &lhs, const Vector3f &rhs) {
-    return acos(Vector3f::dot(lhs, rhs) / (lhs.abs() * rhs.abs()));
+// Normalizes the frame vectors.  `make FAST_NORMALIZE=1` switches to
+// Vector3f::normalizedFast, which is within 4.8e-7 of normalized.
+inline Vector3f unit(const Vector3f &v) {
+#ifdef FAST_NORMALIZE
+    return v.normalizedFast();
+#else
+    return v.normalized();
+#endif
+}
+
+inline double angle(const Vec3d &lhs, const Vec3d &rhs) {
+    return acos(Vec3d::dot(lhs, rhs) / (lhs.abs() * rhs.abs()));
 }
 
-const Matrix4f bezierBasis{
+// The cosine and sine of 0, step, 2 * step, ..., advanced by angle addition
+// (in double) rather than evaluated per step
+struct AngleSteps {
+    explicit AngleSteps(double step) : stepC(cos(step)), stepS(sin(step)) {}
+
+    void next() {
+        double nextC = c * stepC - s * stepS;
+        s = s * stepC + c * stepS;
+        c = nextC;
+    }
+
+    double c = 1;
+    double s = 0;
+    double stepC;
+    double stepS;
+};
+
+constexpr Matrix4f bezierBasis{
     1, -3, 3,  -1, //
     0, 3,  -6, 3,  //
     0, 0,  3,  -3, //
     0, 0,  0,  1   //
 };
 
-const Matrix4f bsplineBasis = Matrix4f{
+constexpr Matrix4f bsplineBasis = Matrix4f{
     1, -3, 3,  -1, //
     4, 0,  -6, 3,  //
     1, 3,  3,  -3, //
     0, 0,  0,  1   //
 } /= 6;
 
+// Quaternion frames: the shortest rotation taking unit vector "from" onto
+// unit vector "to", scaled by 2 * cos(angle / 2), or nullopt when the two
+// are (nearly) opposite and the axis is undefined
+inline optional<Quat4f> shortestArc(const Vector3f &from, const Vector3f &to) {
+    float w = 1 + Vector3f::dot(from, to);
+    if (w < 1e-6f) {
+        return nullopt;
+    }
+    Vector3f axis = Vector3f::cross(from, to);
+    return Quat4f(w, axis[0], axis[1], axis[2]);
+}
+
+// The frame with tangent T and N = B x T, as evalBezier builds it
+inline Quat4f frameFromBinormal(const Vector3f &B, const Vector3f &T) {
+    Vector3f N = unit(Vector3f::cross(B, T));
+    return Quat4f::fromRotatedBasis(N, Vector3f::cross(T, N), T);
+}
+
 } // namespace
 
 Matrix4f points2Matrix(const vector<Vector3f> &points) {
@@ -64,8 +114,78 @@ vector<Vector3f> matrix2Points(const Matrix4f &matrix) {
     };
 }
 
+namespace {
+// The vertex and unit tangent at t of the Bezier piece with geometry gb
+inline void bezierSample(const Matrix4f &gb, float t, Vector3f &V,
+                         Vector3f &T) {
+    Vector4f powerBasis{1, t, (float)pow(t, 2), (float)pow(t, 3)};
+    Vector4f dPowerBasis{0, 1, 2 * t, 3 * (float)pow(t, 2)};
+
+    V = (gb * powerBasis).xyz();
+    T = unit((gb * dPowerBasis).xyz());
+}
+
+// The Bezier control points of the B-spline piece starting at P[i]
+inline vector<Vector3f> bsplinePiece(const vector<Vector3f> &P, unsigned i) {
+    static auto changeOfBasis = bsplineBasis * bezierBasis.inverse();
+
+    auto controlPoints = vector<Vector3f>(P.cbegin() + i, P.cbegin() + i + 4);
+    return matrix2Points(points2Matrix(controlPoints) * changeOfBasis);
+}
+} // namespace
+
+namespace {
+void logInput(const char *name, const vector<Vector3f> &P, unsigned steps) {
+    cerr << "\t>>> " << name << " has been called with the following input:"
+         << endl;
+
+    cerr << "\t>>> Control points (type vector< Vector3f >): " << endl;
+    for (unsigned i = 0; i < P.size(); ++i) {
+        cerr << "\t>>> " << P[i] << endl;
+    }
+
+    cerr << "\t>>> Steps (type steps): " << steps << endl;
+}
+
+// Appends the samples at t = 0, 1 / steps, ..., (count - 1) / steps of the
+// Bezier piece gb to curve.  Each sample's N and B are B, the binormal of
+// the sample before, made perpendicular to the new tangent; B is updated as
+// it goes.  A float binormal is exact in double, so one Vec3d carries both
+// precisions: FRAMES_FLOAT rounds it to the stored float every sample, while
+// FRAMES_DOUBLE keeps it in double and only rounds what it stores.
+void appendBezierPiece(const Matrix4f &gb, unsigned steps, unsigned count,
+                       Vec3d &B, FramePrecision precision, Curve &curve) {
+    for (unsigned step = 0; step < count; step++) {
+        auto t = static_cast<float>(step) / steps;
+
+        CurvePoint p;
+        bezierSample(gb, t, p.V, p.T);
+
+        if (precision == FRAMES_DOUBLE) {
+            Vec3d T = toVec<double>(p.T).normalized();
+            Vec3d N = Vec3d::cross(B, T).normalized();
+            // unit to double precision, as T and N are orthonormal
+            B = Vec3d::cross(T, N);
+
+            p.N = toVector3f(N);
+            p.B = toVector3f(B);
+        } else {
+            auto prev_B = toVector3f(B);
+
+            p.N = unit(Vector3f::cross(prev_B, p.T));
+            p.B = unit(Vector3f::cross(p.T, p.N));
+
+            B = toVec<double>(p.B);
+        }
+
+        curve.push_back(p);
+    }
+}
+} // namespace
+
 Curve evalBezier(const vector<Vector3f> &P, unsigned steps,
-                 const optional<Vector3f> &binormal) {
+                 const optional<Vector3f> &binormal,
+                 FramePrecision precision) {
     // Check
     if (P.size() < 4 || P.size() % 3 != 1) {
         cerr << "evalBezier must be called with 3n+1 control points." << endl;
@@ -88,83 +208,146 @@ Curve evalBezier(const vector<Vector3f> &P, unsigned steps,
     // receive have G1 continuity.  Otherwise, the TNB will not be
     // be defined at points where this does not hold.
 
-    cerr << "\t>>> evalBezier has been called with the following input:"
-         << endl;
-
-    cerr << "\t>>> Control points (type vector< Vector3f >): " << endl;
-    for (unsigned i = 0; i < P.size(); ++i) {
-        cerr << "\t>>> " << P[i] << endl;
-    }
-
-    cerr << "\t>>> Steps (type steps): " << steps << endl;
+    logInput("evalBezier", P, steps);
 
     Curve curve;
     curve.reserve((P.size() - 1) / 3 * (steps + 1));
 
+    auto B = toVec<double>(binormal.value_or(Vector3f(0, 0, 1)));
+
     for (unsigned i = 0; i < P.size() - 1; i += 3) {
         auto controlPoints =
             vector<Vector3f>(P.cbegin() + i, P.cbegin() + i + 4);
         auto gb = points2Matrix(controlPoints) * bezierBasis;
 
-        for (unsigned step = 0; step <= steps; step++) {
-            auto t = static_cast<float>(step) / steps;
+        appendBezierPiece(gb, steps, steps + 1, B, precision, curve);
+    }
+
+    return curve;
+}
+
+Curve evalBspline(const vector<Vector3f> &P, unsigned steps,
+                  FramePrecision precision) {
+    // Check
+    if (P.size() < 4) {
+        cerr << "evalBspline must be called with 4 or more control points."
+             << endl;
+        exit(0);
+    }
+
+    // It is suggested that you implement this function by changing
+    // basis from B-spline to Bezier.  That way, you can just call
+    // your evalBezier function.
+
+    logInput("evalBspline", P, steps);
 
-            Vector4f powerBasis{1, t, (float)pow(t, 2), (float)pow(t, 3)};
-            Vector4f dPowerBasis{0, 1, 2 * t, 3 * (float)pow(t, 2)};
+    Curve curve;
+    curve.reserve((P.size() - 3) * (steps + 1));
 
-            CurvePoint p;
+    // Each piece is evalBezier's, but the binormal carries over between
+    // pieces in the chosen precision rather than through a float
+    Vec3d B(0, 0, 1);
 
-            p.V = (gb * powerBasis).xyz();
-            p.T = (gb * dPowerBasis).xyz().normalized();
+    for (unsigned i = 0; i <= P.size() - 4; i++) {
+        auto controlPoints = bsplinePiece(P, i);
+        logInput("evalBezier", controlPoints, steps);
 
-            auto prev_B = curve.empty() ? binormal.value_or(Vector3f(0, 0, 1))
-                                        : curve.back().B;
+        // If this is not the end of the curve leave out the last point,
+        // because the first point of the next segment will be the same
+        unsigned count = i < P.size() - 4 ? steps : steps + 1;
 
-            p.N = Vector3f::cross(prev_B, p.T).normalized();
-            p.B = Vector3f::cross(p.T, p.N).normalized();
+        appendBezierPiece(points2Matrix(controlPoints) * bezierBasis, steps,
+                          count, B, precision, curve);
+    }
 
-            curve.push_back(p);
+    auto &start = curve.front();
+    auto &end = curve.back();
+
+    // Check if the curve is closed and make sure the vectors at the start match
+    // with the vectors at the end.  This is done in double, since the twist
+    // is spread over every point of a possibly long curve.
+    if (approx(start.V, end.V) && !approx(start.N, end.N)) {
+        auto diff = angle(toVec<double>(start.N), toVec<double>(end.N));
+        AngleSteps twist(-diff / curve.size());
+
+        for (auto &p : curve) {
+            auto rotation =
+                Mat3d::rotation(toVec<double>(p.T), twist.c, twist.s);
+
+            p.N = toVector3f(rotation * toVec<double>(p.N));
+            p.B = toVector3f(rotation * toVec<double>(p.B));
+            twist.next();
         }
+
+        end = start;
     }
 
     return curve;
 }
 
-Curve evalBspline(const vector<Vector3f> &P, unsigned steps) {
+FrameCurve evalBezierFrames(const vector<Vector3f> &P, unsigned steps,
+                            const optional<Quat4f> &frame) {
     // Check
-    if (P.size() < 4) {
-        cerr << "evalBspline must be called with 4 or more control points."
+    if (P.size() < 4 || P.size() % 3 != 1) {
+        cerr << "evalBezierFrames must be called with 3n+1 control points."
              << endl;
         exit(0);
     }
 
-    // It is suggested that you implement this function by changing
-    // basis from B-spline to Bezier.  That way, you can just call
-    // your evalBezier function.
+    FrameCurve curve;
+    curve.reserve((P.size() - 1) / 3 * (steps + 1));
 
-    cerr << "\t>>> evalBspline has been called with the following input:"
-         << endl;
+    optional<Quat4f> Q = frame;
+    Vector3f prevT = Q ? Matrix3f::rotation(*Q).getCol(2) : Vector3f();
 
-    cerr << "\t>>> Control points (type vector< Vector3f >): " << endl;
-    for (unsigned i = 0; i < P.size(); ++i) {
-        cerr << "\t>>> " << P[i] << endl;
+    for (unsigned i = 0; i < P.size() - 1; i += 3) {
+        auto controlPoints =
+            vector<Vector3f>(P.cbegin() + i, P.cbegin() + i + 4);
+        auto gb = points2Matrix(controlPoints) * bezierBasis;
+
+        for (unsigned step = 0; step <= steps; step++) {
+            auto t = static_cast<float>(step) / steps;
+
+            FramePoint p;
+            Vector3f T;
+            bezierSample(gb, t, p.V, T);
+
+            if (!Q) {
+                Q = frameFromBinormal(Vector3f(0, 0, 1), T);
+            } else if (auto arc = shortestArc(prevT, T)) {
+                // one normalization for both the arc and the product
+                Q = (*arc * *Q).normalized();
+            } else {
+                // the tangent reversed: fall back to evalBezier's rule
+                Q = frameFromBinormal(Matrix3f::rotation(*Q).getCol(1), T);
+            }
+            prevT = T;
+
+            p.Q = *Q;
+            curve.push_back(p);
+        }
     }
 
-    cerr << "\t>>> Steps (type steps): " << steps << endl;
+    return curve;
+}
 
-    static auto changeOfBasis = bsplineBasis * bezierBasis.inverse();
+FrameCurve evalBsplineFrames(const vector<Vector3f> &P, unsigned steps) {
+    // Check
+    if (P.size() < 4) {
+        cerr << "evalBsplineFrames must be called with 4 or more control "
+                "points."
+             << endl;
+        exit(0);
+    }
 
-    Curve curve;
+    FrameCurve curve;
     curve.reserve((P.size() - 3) * (steps + 1));
 
     for (unsigned i = 0; i <= P.size() - 4; i++) {
-        auto controlPoints =
-            vector<Vector3f>(P.cbegin() + i, P.cbegin() + i + 4);
-
-        auto geometry = points2Matrix(controlPoints) * changeOfBasis;
         auto segment =
-            evalBezier(matrix2Points(geometry), steps,
-                       curve.empty() ? nullopt : make_optional(curve.back().B));
+            evalBezierFrames(bsplinePiece(P, i), steps,
+                             curve.empty() ? nullopt
+                                           : make_optional(curve.back().Q));
 
         // If this is not the end of the curve remove the last point, because
         // the first point of the next segment will be the same
@@ -178,17 +361,24 @@ Curve evalBspline(const vector<Vector3f> &P, unsigned steps) {
     auto &start = curve.front();
     auto &end = curve.back();
 
-    // Check if the curve is closed and make sure the vectors at the start match
-    // with the vectors at the end
-    if (approx(start.V, end.V) && !approx(start.N, end.N)) {
-        auto diff = angle(start.N, end.N);
-
-        for (unsigned i = 0; i < curve.size(); i++) {
-            auto &p = curve[i];
-            auto rotation = Matrix3f::rotation(p.T, -diff * i / curve.size());
+    // If the curve is closed, spread the twist between the end and start
+    // frames about the (shared) tangent over the curve: point i turns by
+    // i / (n - 1) of it, a rotation about the frame's own z axis.  The
+    // half-angle rotation is stepped in double.
+    if (approx(start.V, end.V) &&
+        !approx(Matrix3f::rotation(start.Q).getCol(0),
+                Matrix3f::rotation(end.Q).getCol(0))) {
+        Quat4f twist = end.Q.conjugated() * start.Q;
+        if (twist.w() < 0) {
+            twist = -1.f * twist;
+        }
+        AngleSteps half(atan2(static_cast<double>(twist.z()), twist.w()) /
+                        (curve.size() - 1));
 
-            p.N = rotation * p.N;
-            p.B = rotation * p.B;
+        for (auto &p : curve) {
+            p.Q = p.Q * Quat4f(static_cast<float>(half.c), 0, 0,
+                               static_cast<float>(half.s));
+            half.next();
         }
 
         end = start;
@@ -197,6 +387,28 @@ Curve evalBspline(const vector<Vector3f> &P, unsigned steps) {
     return curve;
 }
 
+Curve toCurve(const FrameCurve &frames) {
+    Curve curve(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        Matrix3f frame = Matrix3f::rotation(frames[i].Q);
+        curve[i].V = frames[i].V;
+        curve[i].N = frame.getCol(0);
+        curve[i].B = frame.getCol(1);
+        curve[i].T = frame.getCol(2);
+    }
+    return curve;
+}
+
+FrameCurve toFrameCurve(const Curve &curve) {
+    FrameCurve frames(curve.size());
+    for (size_t i = 0; i < curve.size(); ++i) {
+        frames[i].V = curve[i].V;
+        frames[i].Q = Quat4f::fromRotatedBasis(curve[i].N, curve[i].B,
+                                               curve[i].T);
+    }
+    return frames;
+}
+
 Curve evalCircle(float radius, unsigned steps) {
     // This is a sample function on how to properly initialize a Curve
     // (which is a vector< CurvePoint >).
@@ -204,20 +416,25 @@ Curve evalCircle(float radius, unsigned steps) {
     // Preallocate a curve with steps+1 CurvePoints
     Curve R(steps + 1);
 
+    // step from 0 to 2pi, without a sin and cos per point
+    vector<float> sinT(steps + 1);
+    vector<float> cosT(steps + 1);
+    sinCosSteps(0.f, 2.0f * M_PI / steps, sinT.data(), cosT.data(), steps + 1);
+
     // Fill it in counterclockwise
     for (unsigned i = 0; i <= steps; ++i) {
-        // step from 0 to 2pi
-        float t = 2.0f * M_PI * static_cast<float>(i) / steps;
+        float c = cosT[i];
+        float s = sinT[i];
 
         // Initialize position
         // We're pivoting counterclockwise around the y-axis
-        R[i].V = radius * Vector3f(cos(t), sin(t), 0);
+        R[i].V = radius * Vector3f(c, s, 0);
 
         // Tangent vector is first derivative
-        R[i].T = Vector3f(-sin(t), cos(t), 0);
+        R[i].T = Vector3f(-s, c, 0);
 
         // Normal vector is second derivative
-        R[i].N = Vector3f(-cos(t), -sin(t), 0);
+        R[i].N = Vector3f(-c, -s, 0);
 
         // Finally, binormal is facing up.
         R[i].B = Vector3f(0, 0, 1);
@@ -244,32 +461,23 @@ void drawCurve(const Curve &curve, float framesize) {
 
     glLineWidth(1);
 
-    // Draw coordinate frames if framesize nonzero
+    // Draw coordinate frames if framesize nonzero.  The axes are placed on
+    // the CPU, so all frames go in one batch rather than a matrix push each.
     if (framesize != 0.0f) {
-        Matrix4f M;
-
+        glBegin(GL_LINES);
         for (unsigned i = 0; i < curve.size(); ++i) {
-            M.setCol(0, Vector4f(curve[i].N, 0));
-            M.setCol(1, Vector4f(curve[i].B, 0));
-            M.setCol(2, Vector4f(curve[i].T, 0));
-            M.setCol(3, Vector4f(curve[i].V, 1));
-
-            glPushMatrix();
-            glMultMatrixf(M);
-            glScaled(framesize, framesize, framesize);
-            glBegin(GL_LINES);
+            const Vector3f &V = curve[i].V;
             glColor3f(1, 0, 0);
-            glVertex3d(0, 0, 0);
-            glVertex3d(1, 0, 0);
+            glVertex(V);
+            glVertex(Vector3f::madd(curve[i].N, framesize, V));
             glColor3f(0, 1, 0);
-            glVertex3d(0, 0, 0);
-            glVertex3d(0, 1, 0);
+            glVertex(V);
+            glVertex(Vector3f::madd(curve[i].B, framesize, V));
             glColor3f(0, 0, 1);
-            glVertex3d(0, 0, 0);
-            glVertex3d(0, 0, 1);
-            glEnd();
-            glPopMatrix();
+            glVertex(V);
+            glVertex(Vector3f::madd(curve[i].T, framesize, V));
         }
+        glEnd();
     }
 
     // Pop state
@@ -6,6 +6,7 @@
 #include <vecmath.h>
 
 #include <optional>
+#include <type_traits>
 #include <vector>
 
 // The CurvePoint object stores information about a point on a curve
@@ -19,9 +20,24 @@ struct CurvePoint {
     Vector3f B; // Binormal (unit)
 };
 
+static_assert(std::is_trivially_copyable<CurvePoint>::value,
+              "CurvePoint must be trivially copyable");
+
 // This is just a handy shortcut.
 typedef std::vector<CurvePoint> Curve;
 
+// A more compact curve point that stores the frame as a rotation: Q takes
+// the x, y and z axes to N, B and T.  28 bytes, against 48 for CurvePoint.
+struct FramePoint {
+    Vector3f V; // Vertex
+    Quat4f Q;   // Frame    (unit)
+};
+
+static_assert(std::is_trivially_copyable<FramePoint>::value,
+              "FramePoint must be trivially copyable");
+
+typedef std::vector<FramePoint> FrameCurve;
+
 ////////////////////////////////////////////////////////////////////////////
 // The following two functions take an array of control points (stored
 // in P) and generate an STL Vector of CurvePoints.  They should
@@ -32,13 +48,41 @@ typedef std::vector<CurvePoint> Curve;
 // control point is shared).
 ////////////////////////////////////////////////////////////////////////////
 
+// The precision evalBezier and evalBspline carry each sample's binormal to
+// the next in.  With FRAMES_FLOAT the rounding of every sample's frame feeds
+// into the next, so the frames of a dense curve drift from the ideal ones;
+// FRAMES_DOUBLE only rounds the frames it stores.  FRAMES_FLOAT stays the
+// default so output is unchanged; `make PRECISE_FRAMES=1` switches it.
+enum FramePrecision { FRAMES_FLOAT, FRAMES_DOUBLE };
+
+#ifdef PRECISE_FRAMES
+constexpr FramePrecision DEFAULT_FRAME_PRECISION = FRAMES_DOUBLE;
+#else
+constexpr FramePrecision DEFAULT_FRAME_PRECISION = FRAMES_FLOAT;
+#endif
+
 // Assume number of control points properly specifies a piecewise
 // Bezier curve.  I.e., C.size() == 4 + 3*n, n=0,1,...
 Curve evalBezier(const std::vector<Vector3f> &P, unsigned steps,
-                 const std::optional<Vector3f> &binormal = {});
+                 const std::optional<Vector3f> &binormal = {},
+                 FramePrecision precision = DEFAULT_FRAME_PRECISION);
 
 // Bsplines only require that there are at least 4 control points.
-Curve evalBspline(const std::vector<Vector3f> &P, unsigned steps);
+Curve evalBspline(const std::vector<Vector3f> &P, unsigned steps,
+                  FramePrecision precision = DEFAULT_FRAME_PRECISION);
+
+// evalBezier and evalBspline for FrameCurves.  The frame is carried from
+// sample to sample by the shortest rotation between consecutive tangents,
+// and the twist that closes a closed B-spline is spread over the curve as
+// one quaternion product per point.  "frame" continues the frame of a
+// previous piece, like evalBezier's binormal.  These do not log their input.
+FrameCurve evalBezierFrames(const std::vector<Vector3f> &P, unsigned steps,
+                            const std::optional<Quat4f> &frame = {});
+FrameCurve evalBsplineFrames(const std::vector<Vector3f> &P, unsigned steps);
+
+// Conversions between the two curve representations
+Curve toCurve(const FrameCurve &frames);
+FrameCurve toFrameCurve(const Curve &curve);
 
 // Create a circle on the xy-plane of radius and steps
 Curve evalCircle(float radius, unsigned steps);
@@ -262,6 +262,22 @@ void loadObjects(int argc, char *argv[]) {
 
     in.close();
 
+#ifdef OPTIMIZE_SURFACES
+    for (unsigned i = 0; i < gSurfaces.size(); i++) {
+        VertexCacheStats before = analyzeSurface(gSurfaces[i]);
+        optimizeSurface(&gSurfaces[i]);
+        VertexCacheStats after = analyzeSurface(gSurfaces[i]);
+        cerr << gSurfaceNames[i] << ": vertex cache ACMR " << before.acmr
+             << " -> " << after.acmr << ", ATVR " << before.atvr << " -> "
+             << after.atvr << endl;
+    }
+#endif
+
+#ifdef OCT_NORMALS
+    for (unsigned i = 0; i < gSurfaces.size(); i++)
+        packNormals(&gSurfaces[i]);
+#endif
+
     // This does OBJ file output
     if (argc > 2) {
         cerr << endl << "*** writing obj files ***" << endl;
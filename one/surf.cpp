@@ -4,6 +4,7 @@
 #include "Quat4f.h"
 #include "Vector3f.h"
 #include "Vector4f.h"
+#include "VertexCache.h"
 #include "extra.h"
 
 #include <cmath>
@@ -22,6 +23,57 @@ static bool checkFlat(const Curve &profile) {
 
     return true;
 }
+
+// Normal i of surface: VN[i], or VNPacked[i] decoded on the spot, so that
+// drawing needs no decoded copy.
+static Vector3f getNormal(const Surface &surface, unsigned i) {
+    if (surface.VNPacked.empty())
+        return surface.VN[i];
+
+    return static_cast<Vector3f>(surface.VNPacked[i]);
+}
+
+// All the normals of surface, for writing them out in order: VN, or
+// VNPacked decoded into scratch.
+static const vector<Vector3f> &getNormals(const Surface &surface,
+                                          vector<Vector3f> *scratch) {
+    if (surface.VNPacked.empty())
+        return surface.VN;
+
+    scratch->resize(surface.VNPacked.size());
+    decodeNormals(surface.VNPacked.data(), scratch->data(), scratch->size());
+    return *scratch;
+}
+
+// The faces as one index array, three per face
+vector<uint32_t> faceIndices(const Surface &surface) {
+    vector<uint32_t> indices(3 * surface.VF.size());
+    for (unsigned i = 0; i < surface.VF.size(); i++)
+        for (unsigned j = 0; j < 3; j++)
+            indices[3 * i + j] = surface.VF[i][j];
+    return indices;
+}
+
+// in renumbered by remap into used vertices
+template <typename T>
+void remapInPlace(vector<T> *in, const vector<uint32_t> &remap, size_t used) {
+    vector<T> out(used);
+    remapVertices(in->data(), out.data(), in->size(), remap.data());
+    in->swap(out);
+}
+
+// Splits a profile curve into its vertices and its outward facing
+// normals, so that whole rings can be transformed in one call.
+void splitProfile(const Curve &profile, vector<Vector3f> *V,
+                  vector<Vector3f> *N) {
+    V->reserve(profile.size());
+    N->reserve(profile.size());
+
+    for (const auto &p : profile) {
+        V->push_back(p.V);
+        N->push_back(-p.N);
+    }
+}
 } // namespace
 
 vector<Tup3u> makeFaces(int x, int y) {
@@ -52,15 +104,21 @@ Surface makeSurfRev(const Curve &profile, unsigned steps) {
         exit(0);
     }
 
-    for (unsigned u = 0; u <= steps; u++) {
-        auto angle = 2 * M_PI * static_cast<float>(u) / steps;
-        auto rotation = Matrix3f::rotateY(angle);
+    vector<Vector3f> V, N;
+    splitProfile(profile, &V, &N);
 
-        for (unsigned v = 0; v < profile.size(); v++) {
-            auto q = profile[v];
-            surface.VV.emplace_back(rotation * q.V);
-            surface.VN.emplace_back(rotation * -q.N);
-        }
+    const unsigned ring = profile.size();
+    surface.VV.resize((steps + 1) * ring);
+    surface.VN.resize((steps + 1) * ring);
+
+    // one rotation per step from 0 to 2pi, with no trig per step
+    vector<Matrix3f> rotations(steps + 1);
+    Matrix3f::rotationsAboutY(0.f, 2 * M_PI / steps, rotations.data(),
+                              steps + 1);
+
+    for (unsigned u = 0; u <= steps; u++) {
+        transform(rotations[u], V.data(), &surface.VV[u * ring], ring);
+        transform(rotations[u], N.data(), &surface.VN[u * ring], ring);
     }
 
     surface.VF = makeFaces(steps + 1, profile.size());
@@ -76,23 +134,61 @@ Surface makeGenCyl(const Curve &profile, const Curve &sweep) {
         exit(0);
     }
 
+    vector<Vector3f> V, N;
+    splitProfile(profile, &V, &N);
+
+    const unsigned ring = profile.size();
+    surface.VV.resize(sweep.size() * ring);
+    surface.VN.resize(sweep.size() * ring);
+
     for (unsigned u = 0; u < sweep.size(); u++) {
-        Matrix4f coord{
-            {sweep[u].N, 0},
-            {sweep[u].B, 0},
-            {sweep[u].T, 0},
-            {sweep[u].V, 1},
-        };
+        Affine3f frame(sweep[u].N, sweep[u].B, sweep[u].T, sweep[u].V);
 
         // Explanation:
         // https://paroj.github.io/gltut/Illumination/Tut09%20Normal%20Transformation.html
-        auto normalRotation =
-            coord.getSubmatrix3x3(0, 0).transposed().inverse();
+        // The sweep frames are orthonormal, so no inverse is needed.  A
+        // degenerate one (a zero tangent leaves N and B NaN) gives NaN
+        // normals, or an abort in a VECMATH_DEBUG build.
+        auto normalRotation = frame.getLinear().inverseTransposeOrthonormal();
 
-        for (unsigned v = 0; v < profile.size(); v++) {
-            surface.VV.emplace_back((coord * Vector4f{profile[v].V, 1}).xyz());
-            surface.VN.emplace_back(normalRotation * -profile[v].N);
-        }
+        transformPoints(frame, V.data(), &surface.VV[u * ring], ring);
+        transform(normalRotation, N.data(), &surface.VN[u * ring], ring);
+    }
+
+    surface.VF = makeFaces(sweep.size(), profile.size());
+
+    return surface;
+}
+
+Surface makeGenCyl(const Curve &profile, const FrameCurve &sweep) {
+    Surface surface;
+
+    if (!checkFlat(profile)) {
+        cerr << "genCyl profile curve must be flat on xy plane." << endl;
+        exit(0);
+    }
+
+    vector<Vector3f> V, N;
+    splitProfile(profile, &V, &N);
+
+    // all the frame rotations at once
+    vector<Quat4f> Q(sweep.size());
+    for (unsigned u = 0; u < sweep.size(); u++) {
+        Q[u] = sweep[u].Q;
+    }
+    vector<Matrix3f> rotations(sweep.size());
+    rotationMatrices(Q.data(), rotations.data(), sweep.size());
+
+    const unsigned ring = profile.size();
+    surface.VV.resize(sweep.size() * ring);
+    surface.VN.resize(sweep.size() * ring);
+
+    for (unsigned u = 0; u < sweep.size(); u++) {
+        Affine3f frame(rotations[u], sweep[u].V);
+
+        // a rotation is its own normal matrix
+        transformPoints(frame, V.data(), &surface.VV[u * ring], ring);
+        transform(rotations[u], N.data(), &surface.VN[u * ring], ring);
     }
 
     surface.VF = makeFaces(sweep.size(), profile.size());
@@ -125,11 +221,11 @@ void drawSurface(const Surface &surface, bool shaded) {
 
     glBegin(GL_TRIANGLES);
     for (unsigned i = 0; i < surface.VF.size(); i++) {
-        glNormal(surface.VN[surface.VF[i][0]]);
+        glNormal(getNormal(surface, surface.VF[i][0]));
         glVertex(surface.VV[surface.VF[i][0]]);
-        glNormal(surface.VN[surface.VF[i][1]]);
+        glNormal(getNormal(surface, surface.VF[i][1]));
         glVertex(surface.VV[surface.VF[i][1]]);
-        glNormal(surface.VN[surface.VF[i][2]]);
+        glNormal(getNormal(surface, surface.VF[i][2]));
         glVertex(surface.VV[surface.VF[i][2]]);
     }
     glEnd();
@@ -148,21 +244,62 @@ void drawNormals(const Surface &surface, float len) {
     glBegin(GL_LINES);
     for (unsigned i = 0; i < surface.VV.size(); i++) {
         glVertex(surface.VV[i]);
-        glVertex(surface.VV[i] + surface.VN[i] * len);
+        glVertex(Vector3f::madd(getNormal(surface, i), len, surface.VV[i]));
     }
     glEnd();
 
     glPopAttrib();
 }
 
+void packNormals(Surface *surface) {
+    surface->VNPacked.resize(surface->VN.size());
+    encodeNormals(surface->VN.data(), surface->VNPacked.data(),
+                  surface->VN.size());
+    vector<Vector3f>().swap(surface->VN);
+}
+
+void unpackNormals(Surface *surface) {
+    surface->VN.resize(surface->VNPacked.size());
+    decodeNormals(surface->VNPacked.data(), surface->VN.data(),
+                  surface->VN.size());
+    vector<OctNormal32>().swap(surface->VNPacked);
+}
+
+void optimizeSurface(Surface *surface) {
+    vector<uint32_t> indices = faceIndices(*surface);
+    size_t vertexCount = surface->VV.size();
+    optimizeVertexCache(indices.data(), indices.data(), indices.size(),
+                        vertexCount);
+
+    vector<uint32_t> remap(vertexCount);
+    size_t used = optimizeVertexFetch(indices.data(), indices.size(),
+                                      vertexCount, remap.data());
+    for (unsigned i = 0; i < surface->VF.size(); i++)
+        for (unsigned j = 0; j < 3; j++)
+            surface->VF[i][j] = indices[3 * i + j];
+
+    remapInPlace(&surface->VV, remap, used);
+    if (!surface->VN.empty())
+        remapInPlace(&surface->VN, remap, used);
+    if (!surface->VNPacked.empty())
+        remapInPlace(&surface->VNPacked, remap, used);
+}
+
+VertexCacheStats analyzeSurface(const Surface &surface, unsigned cacheSize) {
+    vector<uint32_t> indices = faceIndices(surface);
+    return analyzeVertexCache(indices.data(), indices.size(),
+                              surface.VV.size(), cacheSize);
+}
+
 void outputObjFile(ostream &out, const Surface &surface) {
     for (unsigned i = 0; i < surface.VV.size(); i++)
         out << "v  " << surface.VV[i][0] << " " << surface.VV[i][1] << " "
             << surface.VV[i][2] << endl;
 
-    for (unsigned i = 0; i < surface.VN.size(); i++)
-        out << "vn " << surface.VN[i][0] << " " << surface.VN[i][1] << " "
-            << surface.VN[i][2] << endl;
+    vector<Vector3f> scratch;
+    const vector<Vector3f> &VN = getNormals(surface, &scratch);
+    for (unsigned i = 0; i < VN.size(); i++)
+        out << "vn " << VN[i][0] << " " << VN[i][1] << " " << VN[i][2] << endl;
 
     out << "vt  0 0 0" << endl;
 
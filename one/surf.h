@@ -1,25 +1,49 @@
 #ifndef SURF_H
 #define SURF_H
 
+#include "OctNormal.h"
+#include "VertexCache.h"
 #include "curve.h"
 #include "tuple.h"
 
 #include <iostream>
+#include <type_traits>
 
 // Tup3u is a handy shortcut for an array of 3 unsigned integers.  You
 // can access elements using [], and you can copy using =, and so on.
 using Tup3u = tuple<unsigned int, 3>;
 
+static_assert(std::is_trivially_copyable<Tup3u>::value,
+              "Tup3u must be trivially copyable");
+
 // Surface is just a struct that contains vertices, normals, and
 // faces.  VV[i] is the position of vertex i, and VN[i] is the normal
 // of vertex i.  A face is a triple i,j,k corresponding to a triangle
 // with (vertex i, normal i), (vertex j, normal j), ...
+//
+// Optionally the normals are kept in octahedral form instead (see
+// packNormals): VNPacked then replaces VN, which is empty.
 struct Surface {
     std::vector<Vector3f> VV;
     std::vector<Vector3f> VN;
     std::vector<Tup3u> VF;
+    std::vector<OctNormal32> VNPacked;
 };
 
+// Moves the normals from VN to VNPacked (4 bytes a normal instead of 12,
+// within 0.004 degrees), and back.  Drawing and OBJ output accept either.
+void packNormals(Surface *surface);
+void unpackNormals(Surface *surface);
+
+// Reorders the faces for the GPU's post-transform vertex cache, then
+// renumbers the vertices in the order the faces use them (see
+// VertexCache.h).  The surface looks the same, but its OBJ output changes.
+void optimizeSurface(Surface *surface);
+
+// analyzeVertexCache of the faces, for a cache of cacheSize vertices
+VertexCacheStats analyzeSurface(const Surface &surface,
+                                unsigned cacheSize = 16);
+
 // This draws the surface.  Draws the surfaces with smooth shading if
 // shaded==true, otherwise, draws a wireframe.
 void drawSurface(const Surface &surface, bool shaded);
@@ -33,6 +57,9 @@ Surface makeSurfRev(const Curve &profile, unsigned steps);
 
 Surface makeGenCyl(const Curve &profile, const Curve &sweep);
 
+// The same for a sweep curve with quaternion frames
+Surface makeGenCyl(const Curve &profile, const FrameCurve &sweep);
+
 void outputObjFile(std::ostream &out, const Surface &surface);
 
 #endif
@@ -27,16 +27,6 @@ template <typename TYPE, unsigned SIZE> class tuple {
 
     tuple(const TYPE array[SIZE]) { memcpy(data, array, SIZE * sizeof(TYPE)); }
 
-    tuple(const tuple &other) {
-        memcpy(this->data, &other.data, SIZE * sizeof(TYPE));
-    }
-
-    tuple &operator=(const tuple &other) {
-        if (&other != this)
-            memcpy(this->data, &other.data, SIZE * sizeof(TYPE));
-        return *this;
-    }
-
     tuple &operator=(const TYPE array[SIZE]) {
         memcpy(data, array, SIZE * sizeof(TYPE));
         return *this;
@@ -0,0 +1,36 @@
+#include "Affine3f.h"
+
+#include "Matrix4f.h"
+#include "Vector4f.h"
+
+#include <cmath>
+#include <cstdio>
+
+VECMATH_INLINE Affine3f::Affine3f(const Vector3f &x, const Vector3f &y,
+                                  const Vector3f &z, const Vector3f &origin)
+    : m_linear(x, y, z), m_translation(origin) {}
+
+VECMATH_INLINE Affine3f::Affine3f(const Matrix4f &m)
+    : m_linear(m.getSubmatrix3x3(0, 0)), m_translation(m.getCol(3).xyz()) {}
+
+VECMATH_INLINE Matrix4f Affine3f::toMatrix4f() const {
+    Matrix4f m = Matrix4f::identity();
+    m.setSubmatrix3x3(0, 0, m_linear);
+    m.setCol(3, Vector4f(m_translation, 1));
+    return m;
+}
+
+VECMATH_INLINE void Affine3f::print() const {
+    const Matrix3f &a = m_linear;
+    const Vector3f &t = m_translation;
+    printf("[ %.4f %.4f %.4f %.4f ]\n[ %.4f %.4f %.4f %.4f ]\n[ %.4f %.4f %.4f "
+           "%.4f ]\n",
+           a(0, 0), a(0, 1), a(0, 2), t[0], a(1, 0), a(1, 1), a(1, 2), t[1],
+           a(2, 0), a(2, 1), a(2, 2), t[2]);
+}
+
+// static
+VECMATH_INLINE Affine3f Affine3f::rotation(const Vector3f &rDirection,
+                                           float radians) {
+    return Affine3f(Matrix3f::rotation(rDirection, radians), Vector3f(0));
+}
@@ -0,0 +1,166 @@
+#ifndef AFFINE3F_H
+#define AFFINE3F_H
+
+#include "vecmath_config.h"
+
+#include "Matrix3f.h"
+#include "Vector3f.h"
+
+#include <cstdio>
+#include <type_traits>
+
+class Matrix4f;
+
+// 3D affine transform: p' = linear * p + translation.
+// Equivalent to a Matrix4f whose bottom row is (0, 0, 0, 1), but composes,
+// inverts and transforms with 3x3 arithmetic only.
+class Affine3f {
+  public:
+    // identity
+    constexpr Affine3f() : m_linear(Matrix3f::identity()), m_translation(0) {}
+    constexpr Affine3f(const Matrix3f &linear, const Vector3f &translation)
+        : m_linear(linear), m_translation(translation) {}
+
+    // the frame with axes x, y, z (the columns of the linear part) located
+    // at origin
+    Affine3f(const Vector3f &x, const Vector3f &y, const Vector3f &z,
+             const Vector3f &origin);
+
+    // drops the bottom row of m, which must be (0, 0, 0, 1)
+    explicit Affine3f(const Matrix4f &m);
+
+    // implicit copy constructor and assignment operator (trivially copyable)
+    // no destructor necessary
+
+    constexpr const Matrix3f &getLinear() const { return m_linear; }
+    constexpr void setLinear(const Matrix3f &linear) { m_linear = linear; }
+
+    constexpr const Vector3f &getTranslation() const { return m_translation; }
+    constexpr void setTranslation(const Vector3f &translation) {
+        m_translation = translation;
+    }
+
+    // linear * p + translation
+    constexpr Vector3f transformPoint(const Vector3f &p) const;
+
+    // linear * d
+    constexpr Vector3f transformDirection(const Vector3f &d) const;
+
+    // normalMatrix() * n, not renormalized
+    Vector3f transformNormal(const Vector3f &n) const;
+
+    // transpose(inverse(linear)), the matrix that transforms normals
+    Matrix3f normalMatrix() const;
+
+    Affine3f inverse(bool *pbIsSingular = NULL, float epsilon = 0.f) const;
+
+    // Inverse of a rigid-body transform, i.e. one whose linear part is a
+    // rotation: (R^T, -R^T t).  Only valid for orthonormal linear parts,
+    // which VECMATH_DEBUG builds check.
+    Affine3f rigidInverse() const;
+
+    Matrix4f toMatrix4f() const;
+
+    // ---- Utility ----
+    void print() const;
+
+    static constexpr Affine3f identity() { return Affine3f(); }
+    static constexpr Affine3f translation(const Vector3f &t) {
+        return Affine3f(Matrix3f::identity(), t);
+    }
+    static Affine3f rotation(const Vector3f &rDirection, float radians);
+    static constexpr Affine3f scaling(float sx, float sy, float sz) {
+        return Affine3f(Matrix3f::scaling(sx, sy, sz), Vector3f(0));
+    }
+
+  private:
+    Matrix3f m_linear;
+    Vector3f m_translation;
+};
+
+// Composition: (x * y) applies y first, then x
+constexpr Affine3f operator*(const Affine3f &x, const Affine3f &y);
+
+// Composing, inverting and transforming are defined here rather than in
+// Affine3f.cpp, so that they inline into callers linked against the library
+// as the Matrix4f fast paths do; out of line, the call costs more than the
+// 3x4 arithmetic saves over 4x4.
+
+constexpr Vector3f Affine3f::transformPoint(const Vector3f &p) const {
+    const Matrix3f &a = m_linear;
+    const Vector3f &t = m_translation;
+    return Vector3f(a(0, 0) * p[0] + a(0, 1) * p[1] + a(0, 2) * p[2] + t[0],
+                    a(1, 0) * p[0] + a(1, 1) * p[1] + a(1, 2) * p[2] + t[1],
+                    a(2, 0) * p[0] + a(2, 1) * p[1] + a(2, 2) * p[2] + t[2]);
+}
+
+constexpr Vector3f Affine3f::transformDirection(const Vector3f &d) const {
+    const Matrix3f &a = m_linear;
+    return Vector3f(a(0, 0) * d[0] + a(0, 1) * d[1] + a(0, 2) * d[2],
+                    a(1, 0) * d[0] + a(1, 1) * d[1] + a(1, 2) * d[2],
+                    a(2, 0) * d[0] + a(2, 1) * d[1] + a(2, 2) * d[2]);
+}
+
+inline Matrix3f Affine3f::normalMatrix() const {
+    return m_linear.transposed().inverse();
+}
+
+inline Vector3f Affine3f::transformNormal(const Vector3f &n) const {
+    const Matrix3f m = normalMatrix();
+    return Vector3f(m(0, 0) * n[0] + m(0, 1) * n[1] + m(0, 2) * n[2],
+                    m(1, 0) * n[0] + m(1, 1) * n[1] + m(1, 2) * n[2],
+                    m(2, 0) * n[0] + m(2, 1) * n[1] + m(2, 2) * n[2]);
+}
+
+inline Affine3f Affine3f::inverse(bool *pbIsSingular, float epsilon) const {
+    const Matrix3f a = m_linear.inverse(pbIsSingular, epsilon);
+    const Vector3f &t = m_translation;
+    Vector3f translationInverse(
+        -(a(0, 0) * t[0] + a(0, 1) * t[1] + a(0, 2) * t[2]),
+        -(a(1, 0) * t[0] + a(1, 1) * t[1] + a(1, 2) * t[2]),
+        -(a(2, 0) * t[0] + a(2, 1) * t[1] + a(2, 2) * t[2]));
+    return Affine3f(a, translationInverse);
+}
+
+inline Affine3f Affine3f::rigidInverse() const {
+    const Matrix3f &r = m_linear;
+    const Vector3f &t = m_translation;
+    VECMATH_CHECK(r.isOrthonormal());
+
+    // the rows of R^T are the columns of R
+    Matrix3f rotationInverse(r(0, 0), r(1, 0), r(2, 0), r(0, 1), r(1, 1),
+                             r(2, 1), r(0, 2), r(1, 2), r(2, 2));
+    Vector3f translationInverse(
+        -(r(0, 0) * t[0] + r(1, 0) * t[1] + r(2, 0) * t[2]),
+        -(r(0, 1) * t[0] + r(1, 1) * t[1] + r(2, 1) * t[2]),
+        -(r(0, 2) * t[0] + r(1, 2) * t[1] + r(2, 2) * t[2]));
+    return Affine3f(rotationInverse, translationInverse);
+}
+
+constexpr Affine3f operator*(const Affine3f &x, const Affine3f &y) {
+    const Matrix3f &a = x.getLinear();
+    const Matrix3f &b = y.getLinear();
+
+    // unrolled: the generic Matrix3f product accumulates through a zeroed
+    // temporary
+    Matrix3f linear;
+    for (int k = 0; k < 3; ++k) {
+        const float b0 = b(0, k), b1 = b(1, k), b2 = b(2, k);
+        linear(0, k) = a(0, 0) * b0 + a(0, 1) * b1 + a(0, 2) * b2;
+        linear(1, k) = a(1, 0) * b0 + a(1, 1) * b1 + a(1, 2) * b2;
+        linear(2, k) = a(2, 0) * b0 + a(2, 1) * b1 + a(2, 2) * b2;
+    }
+    return Affine3f(linear, x.transformPoint(y.getTranslation()));
+}
+
+static_assert(std::is_trivially_copyable<Affine3f>::value,
+              "Affine3f must be trivially copyable");
+static_assert(std::is_standard_layout<Affine3f>::value &&
+                  sizeof(Affine3f) == 12 * sizeof(float),
+              "Affine3f must be laid out as 12 packed floats");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Affine3f.cpp"
+#endif
+
+#endif // AFFINE3F_H
@@ -0,0 +1,402 @@
+#include "BatchInterpolate.h"
+
+#include "Matrix3f.h"
+#include "Quat4f.h"
+#include "vecmath_simd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace vecmath_detail {
+
+// below this 1 - |cos(angle)|, interpolate linearly (as Quat4f::slerp does)
+constexpr float kInterpNlerpThreshold = 0.01f;
+
+// quaternions converted to matrices per call of the Matrix3f sample functions
+constexpr size_t kInterpChunk = 64;
+
+inline Quat4f interpNlerpOne(const Quat4f &a, const Quat4f &b, float t) {
+    float c1 = Quat4f::dot(a, b) < 0.f ? t - 1.f : 1.f - t;
+    return (c1 * a + t * b).normalized();
+}
+
+// Quat4f::slerp, except that close pairs are renormalized
+inline Quat4f interpSlerpOne(const Quat4f &a, const Quat4f &b, float t,
+                             bool allowFlip = true) {
+    float cosAngle = Quat4f::dot(a, b);
+    bool flip = allowFlip && cosAngle < 0.f;
+    if (flip) {
+        cosAngle = -cosAngle;
+    }
+
+    float c1 = 1.f - t;
+    float c2 = t;
+    bool close = 1.f - cosAngle < kInterpNlerpThreshold;
+    if (!close) {
+        float angle = std::acos(cosAngle);
+        float sinAngle = std::sqrt(1.f - cosAngle * cosAngle);
+        c1 = std::sin(angle * (1.f - t)) / sinAngle;
+        c2 = std::sin(angle * t) / sinAngle;
+    }
+    if (flip) {
+        c1 = -c1;
+    }
+
+    Quat4f q = c1 * a + c2 * b;
+    return close ? q.normalized() : q;
+}
+
+inline Quat4f interpSquadOne(const Quat4f &a, const Quat4f &tanA,
+                             const Quat4f &tanB, const Quat4f &b, float t) {
+    Quat4f ab = interpSlerpOne(a, b, t);
+    Quat4f tangent = interpSlerpOne(tanA, tanB, t, false);
+    return interpSlerpOne(ab, tangent, 2.f * t * (1.f - t), false);
+}
+
+// the key interval containing time: keys k and k + 1, at fraction f
+inline size_t interpKey(size_t nKeys, float time, float &f) {
+    // NaN compares false, so it clamps to 0 like a negative time
+    float u = time > 0.f ? std::min(time, static_cast<float>(nKeys - 1)) : 0.f;
+    size_t k = std::min(static_cast<size_t>(u), nKeys - 2);
+    f = u - static_cast<float>(k);
+    return k;
+}
+
+#ifdef VECMATH_SSE
+// four quaternions, one per lane
+struct InterpQuatX4 {
+    __m128 w;
+    __m128 x;
+    __m128 y;
+    __m128 z;
+};
+
+inline InterpQuatX4 interpLoad(const Quat4f &q0, const Quat4f &q1,
+                               const Quat4f &q2, const Quat4f &q3) {
+    InterpQuatX4 q = {_mm_loadu_ps(&q0[0]), _mm_loadu_ps(&q1[0]),
+                      _mm_loadu_ps(&q2[0]), _mm_loadu_ps(&q3[0])};
+    _MM_TRANSPOSE4_PS(q.w, q.x, q.y, q.z);
+    return q;
+}
+
+inline InterpQuatX4 interpLoad(const Quat4f *q) {
+    return interpLoad(q[0], q[1], q[2], q[3]);
+}
+
+inline void interpStore(Quat4f *out, InterpQuatX4 q) {
+    _MM_TRANSPOSE4_PS(q.w, q.x, q.y, q.z);
+    _mm_storeu_ps(&out[0][0], q.w);
+    _mm_storeu_ps(&out[1][0], q.x);
+    _mm_storeu_ps(&out[2][0], q.y);
+    _mm_storeu_ps(&out[3][0], q.z);
+}
+
+inline __m128 interpDot(const InterpQuatX4 &a, const InterpQuatX4 &b) {
+    __m128 d = _mm_mul_ps(a.w, b.w);
+    d = simdMadd(a.x, b.x, d);
+    d = simdMadd(a.y, b.y, d);
+    return simdMadd(a.z, b.z, d);
+}
+
+// c1 * a + c2 * b
+inline InterpQuatX4 interpCombine(__m128 c1, const InterpQuatX4 &a,
+                                  __m128 c2, const InterpQuatX4 &b) {
+    return {simdMadd(c1, a.w, _mm_mul_ps(c2, b.w)),
+            simdMadd(c1, a.x, _mm_mul_ps(c2, b.x)),
+            simdMadd(c1, a.y, _mm_mul_ps(c2, b.y)),
+            simdMadd(c1, a.z, _mm_mul_ps(c2, b.z))};
+}
+
+inline InterpQuatX4 interpScale(const InterpQuatX4 &q, __m128 s) {
+    return {_mm_mul_ps(q.w, s), _mm_mul_ps(q.x, s), _mm_mul_ps(q.y, s),
+            _mm_mul_ps(q.z, s)};
+}
+
+// mask ? a : b
+inline __m128 interpSelect(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline InterpQuatX4 interpNlerp(const InterpQuatX4 &a, const InterpQuatX4 &b,
+                                __m128 t) {
+    __m128 negative = _mm_cmplt_ps(interpDot(a, b), _mm_setzero_ps());
+    __m128 c1 = _mm_sub_ps(_mm_set1_ps(1.f), t);
+    c1 = _mm_xor_ps(c1, _mm_and_ps(negative, _mm_set1_ps(-0.f)));
+
+    InterpQuatX4 q = interpCombine(c1, a, t, b);
+    return interpScale(q, simdRsqrt(interpDot(q, q)));
+}
+
+// interpSlerpOne on four pairs
+inline InterpQuatX4 interpSlerp(const InterpQuatX4 &a, const InterpQuatX4 &b,
+                                __m128 t, bool allowFlip = true) {
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 signMask = _mm_set1_ps(-0.f);
+
+    __m128 cosAngle = interpDot(a, b);
+    __m128 flip = _mm_setzero_ps();
+    if (allowFlip) {
+        flip = _mm_and_ps(_mm_cmplt_ps(cosAngle, _mm_setzero_ps()), signMask);
+        cosAngle = _mm_xor_ps(cosAngle, flip);
+    }
+    __m128 oneMinusT = _mm_sub_ps(one, t);
+    __m128 close = _mm_cmplt_ps(_mm_sub_ps(one, cosAngle),
+                                _mm_set1_ps(kInterpNlerpThreshold));
+    int closeLanes = _mm_movemask_ps(close);
+
+    __m128 c1 = oneMinusT;
+    __m128 c2 = t;
+    if (closeLanes != 0xf) {
+        __m128 angle = simdAcos(cosAngle);
+        __m128 sinAngle = _mm_sqrt_ps(_mm_max_ps(
+            _mm_sub_ps(one, _mm_mul_ps(cosAngle, cosAngle)), _mm_setzero_ps()));
+        // close lanes divide by one instead of a possible zero
+        __m128 invSin = _mm_div_ps(one, interpSelect(close, one, sinAngle));
+        c1 = interpSelect(close, c1,
+                          _mm_mul_ps(simdSin(_mm_mul_ps(angle, oneMinusT)),
+                                     invSin));
+        c2 = interpSelect(close, c2,
+                          _mm_mul_ps(simdSin(_mm_mul_ps(angle, t)), invSin));
+    }
+    c1 = _mm_xor_ps(c1, flip);
+
+    InterpQuatX4 q = interpCombine(c1, a, c2, b);
+    if (closeLanes != 0) {
+        __m128 s = interpSelect(close, simdRsqrt(interpDot(q, q)), one);
+        q = interpScale(q, s);
+    }
+    return q;
+}
+
+inline InterpQuatX4 interpSquad(const InterpQuatX4 &a,
+                                const InterpQuatX4 &tanA,
+                                const InterpQuatX4 &tanB,
+                                const InterpQuatX4 &b, __m128 t) {
+    InterpQuatX4 ab = interpSlerp(a, b, t);
+    InterpQuatX4 tangent = interpSlerp(tanA, tanB, t, false);
+    __m128 h = _mm_mul_ps(_mm_add_ps(t, t), _mm_sub_ps(_mm_set1_ps(1.f), t));
+    return interpSlerp(ab, tangent, h, false);
+}
+
+// keys[k[0]] .. keys[k[3]], one per lane
+inline InterpQuatX4 interpGather(const Quat4f *keys, const size_t *k) {
+    return interpLoad(keys[k[0]], keys[k[1]], keys[k[2]], keys[k[3]]);
+}
+#endif
+
+// Shared body of the sample functions: sampleOne(k, f) for the tail, and
+// sampleFour(k, f) for four samples at once where SIMD is available.
+template <typename One, typename Four>
+void interpSample(const Quat4f *keys, size_t nKeys, const float *times,
+                  Quat4f *out, size_t n, One sampleOne, Four sampleFour) {
+    assert(nKeys >= 1);
+    if (nKeys == 1) {
+        std::fill(out, out + n, keys[0]);
+        return;
+    }
+
+    size_t i = 0;
+#ifdef VECMATH_SSE
+    for (; i + 4 <= n; i += 4) {
+        size_t k[4];
+        alignas(16) float f[4];
+        for (int l = 0; l < 4; ++l) {
+            k[l] = interpKey(nKeys, times[i + l], f[l]);
+        }
+        interpStore(out + i, sampleFour(k, _mm_load_ps(f)));
+    }
+#else
+    (void)sampleFour;
+#endif
+    for (; i < n; ++i) {
+        float f;
+        size_t k = interpKey(nKeys, times[i], f);
+        out[i] = sampleOne(k, f);
+    }
+}
+
+} // namespace vecmath_detail
+
+VECMATH_INLINE void slerp(const Quat4f *a, const Quat4f *b, const float *t,
+                          Quat4f *out, size_t n) {
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= n; i += 4) {
+        vecmath_detail::InterpQuatX4 qa = vecmath_detail::interpLoad(a + i);
+        vecmath_detail::InterpQuatX4 qb = vecmath_detail::interpLoad(b + i);
+        vecmath_detail::interpStore(
+            out + i, vecmath_detail::interpSlerp(qa, qb, _mm_loadu_ps(t + i)));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = vecmath_detail::interpSlerpOne(a[i], b[i], t[i]);
+    }
+}
+
+VECMATH_INLINE void nlerp(const Quat4f *a, const Quat4f *b, const float *t,
+                          Quat4f *out, size_t n) {
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= n; i += 4) {
+        vecmath_detail::InterpQuatX4 qa = vecmath_detail::interpLoad(a + i);
+        vecmath_detail::InterpQuatX4 qb = vecmath_detail::interpLoad(b + i);
+        vecmath_detail::interpStore(
+            out + i, vecmath_detail::interpNlerp(qa, qb, _mm_loadu_ps(t + i)));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = vecmath_detail::interpNlerpOne(a[i], b[i], t[i]);
+    }
+}
+
+VECMATH_INLINE void squad(const Quat4f *a, const Quat4f *tanA,
+                          const Quat4f *tanB, const Quat4f *b, const float *t,
+                          Quat4f *out, size_t n) {
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= n; i += 4) {
+        vecmath_detail::interpStore(
+            out + i,
+            vecmath_detail::interpSquad(vecmath_detail::interpLoad(a + i),
+                                        vecmath_detail::interpLoad(tanA + i),
+                                        vecmath_detail::interpLoad(tanB + i),
+                                        vecmath_detail::interpLoad(b + i),
+                                        _mm_loadu_ps(t + i)));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] =
+            vecmath_detail::interpSquadOne(a[i], tanA[i], tanB[i], b[i], t[i]);
+    }
+}
+
+VECMATH_INLINE void rotationMatrices(const Quat4f *q, Matrix3f *out,
+                                     size_t n) {
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= n; i += 4) {
+        vecmath_detail::InterpQuatX4 r = vecmath_detail::interpLoad(q + i);
+
+        // s = 2 / |q|^2 normalizes q as Matrix3f::rotation does
+        __m128 s =
+            _mm_div_ps(_mm_set1_ps(2.f), vecmath_detail::interpDot(r, r));
+        __m128 xs = _mm_mul_ps(r.x, s);
+        __m128 ys = _mm_mul_ps(r.y, s);
+        __m128 zs = _mm_mul_ps(r.z, s);
+
+        __m128 xx = _mm_mul_ps(r.x, xs);
+        __m128 yy = _mm_mul_ps(r.y, ys);
+        __m128 zz = _mm_mul_ps(r.z, zs);
+        __m128 xy = _mm_mul_ps(r.x, ys);
+        __m128 xz = _mm_mul_ps(r.x, zs);
+        __m128 yz = _mm_mul_ps(r.y, zs);
+        __m128 xw = _mm_mul_ps(r.w, xs);
+        __m128 yw = _mm_mul_ps(r.w, ys);
+        __m128 zw = _mm_mul_ps(r.w, zs);
+
+        const __m128 one = _mm_set1_ps(1.f);
+        alignas(16) float m[9][4];
+        _mm_store_ps(m[0], _mm_sub_ps(one, _mm_add_ps(yy, zz)));
+        _mm_store_ps(m[1], _mm_sub_ps(xy, zw));
+        _mm_store_ps(m[2], _mm_add_ps(xz, yw));
+        _mm_store_ps(m[3], _mm_add_ps(xy, zw));
+        _mm_store_ps(m[4], _mm_sub_ps(one, _mm_add_ps(xx, zz)));
+        _mm_store_ps(m[5], _mm_sub_ps(yz, xw));
+        _mm_store_ps(m[6], _mm_sub_ps(xz, yw));
+        _mm_store_ps(m[7], _mm_add_ps(yz, xw));
+        _mm_store_ps(m[8], _mm_sub_ps(one, _mm_add_ps(xx, yy)));
+
+        for (int l = 0; l < 4; ++l) {
+            out[i + l] = Matrix3f(m[0][l], m[1][l], m[2][l], m[3][l], m[4][l],
+                                  m[5][l], m[6][l], m[7][l], m[8][l]);
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = Matrix3f::rotation(q[i]);
+    }
+}
+
+VECMATH_INLINE void squadTangents(const Quat4f *keys, size_t nKeys,
+                                  Quat4f *tangents) {
+    for (size_t k = 0; k < nKeys; ++k) {
+        const Quat4f &before = keys[k > 0 ? k - 1 : k];
+        const Quat4f &after = keys[k + 1 < nKeys ? k + 1 : k];
+        tangents[k] = Quat4f::squadTangent(before, keys[k], after);
+    }
+}
+
+VECMATH_INLINE void sampleSlerp(const Quat4f *keys, size_t nKeys,
+                                const float *times, Quat4f *out, size_t n) {
+    vecmath_detail::interpSample(
+        keys, nKeys, times, out, n,
+        [keys](size_t k, float f) {
+            return vecmath_detail::interpSlerpOne(keys[k], keys[k + 1], f);
+        },
+#ifdef VECMATH_SSE
+        [keys](const size_t *k, __m128 f) {
+            size_t k1[4] = {k[0] + 1, k[1] + 1, k[2] + 1, k[3] + 1};
+            return vecmath_detail::interpSlerp(
+                vecmath_detail::interpGather(keys, k),
+                vecmath_detail::interpGather(keys, k1), f);
+        }
+#else
+        nullptr
+#endif
+    );
+}
+
+VECMATH_INLINE void sampleSlerp(const Quat4f *keys, size_t nKeys,
+                                const float *times, Matrix3f *out, size_t n) {
+    Quat4f q[vecmath_detail::kInterpChunk];
+    for (size_t i = 0; i < n; i += vecmath_detail::kInterpChunk) {
+        size_t m = std::min(vecmath_detail::kInterpChunk, n - i);
+        sampleSlerp(keys, nKeys, times + i, q, m);
+        rotationMatrices(q, out + i, m);
+    }
+}
+
+VECMATH_INLINE void sampleSquad(const Quat4f *keys, const Quat4f *tangents,
+                                size_t nKeys, const float *times, Quat4f *out,
+                                size_t n) {
+    vecmath_detail::interpSample(
+        keys, nKeys, times, out, n,
+        [keys, tangents](size_t k, float f) {
+            return vecmath_detail::interpSquadOne(keys[k], tangents[k],
+                                                  tangents[k + 1],
+                                                  keys[k + 1], f);
+        },
+#ifdef VECMATH_SSE
+        [keys, tangents](const size_t *k, __m128 f) {
+            size_t k1[4] = {k[0] + 1, k[1] + 1, k[2] + 1, k[3] + 1};
+            return vecmath_detail::interpSquad(
+                vecmath_detail::interpGather(keys, k),
+                vecmath_detail::interpGather(tangents, k),
+                vecmath_detail::interpGather(tangents, k1),
+                vecmath_detail::interpGather(keys, k1), f);
+        }
+#else
+        nullptr
+#endif
+    );
+}
+
+VECMATH_INLINE void sampleSquad(const Quat4f *keys, const Quat4f *tangents,
+                                size_t nKeys, const float *times,
+                                Matrix3f *out, size_t n) {
+    Quat4f q[vecmath_detail::kInterpChunk];
+    for (size_t i = 0; i < n; i += vecmath_detail::kInterpChunk) {
+        size_t m = std::min(vecmath_detail::kInterpChunk, n - i);
+        sampleSquad(keys, tangents, nKeys, times + i, q, m);
+        rotationMatrices(q, out + i, m);
+    }
+}
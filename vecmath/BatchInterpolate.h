@@ -0,0 +1,62 @@
+#ifndef BATCH_INTERPOLATE_H
+#define BATCH_INTERPOLATE_H
+
+#include "vecmath_config.h"
+
+#include <cstddef>
+
+class Matrix3f;
+class Quat4f;
+
+// Batched quaternion interpolation for animation streams.
+//
+// These follow Quat4f::slerp and Quat4f::squad element by element, but work
+// on four rotations at a time with polynomial acos and sin.  Pairs closer
+// than the threshold Quat4f::slerp uses (1 - |cos| < 0.01) take a normalized
+// lerp instead, so every result is a unit quaternion.  Results agree with
+// Quat4f::slerp to within about 1e-6.  "out" may be the same array as any
+// input, but must not otherwise overlap one.
+
+// out[i] = slerp(a[i], b[i], t[i]), along the shortest path
+void slerp(const Quat4f *a, const Quat4f *b, const float *t, Quat4f *out,
+           size_t n);
+
+// out[i] = normalized((1 - t[i]) * a[i] + t[i] * b[i]), along the shortest
+// path.  Cheaper than slerp, but not constant speed: fine for pairs a few
+// degrees apart.
+void nlerp(const Quat4f *a, const Quat4f *b, const float *t, Quat4f *out,
+           size_t n);
+
+// out[i] = Quat4f::squad(a[i], tanA[i], tanB[i], b[i], t[i])
+void squad(const Quat4f *a, const Quat4f *tanA, const Quat4f *tanB,
+           const Quat4f *b, const float *t, Quat4f *out, size_t n);
+
+// out[i] = Matrix3f::rotation(q[i])
+void rotationMatrices(const Quat4f *q, Matrix3f *out, size_t n);
+
+// Keyframe tracks: keys[k] is the rotation at time k, and times[i] is in the
+// same units, clamped to [0, nKeys - 1] (NaN to 0).  nKeys must be at least
+// 1.  Keys should be on one hemisphere (dot(keys[k], keys[k + 1]) >= 0) for
+// squad.
+
+// tangents[k] = Quat4f::squadTangent(keys[k - 1], keys[k], keys[k + 1]),
+// repeating the end keys at either end
+void squadTangents(const Quat4f *keys, size_t nKeys, Quat4f *tangents);
+
+// samples the track slerping between neighbouring keys
+void sampleSlerp(const Quat4f *keys, size_t nKeys, const float *times,
+                 Quat4f *out, size_t n);
+void sampleSlerp(const Quat4f *keys, size_t nKeys, const float *times,
+                 Matrix3f *out, size_t n);
+
+// samples the track with squad, given tangents from squadTangents
+void sampleSquad(const Quat4f *keys, const Quat4f *tangents, size_t nKeys,
+                 const float *times, Quat4f *out, size_t n);
+void sampleSquad(const Quat4f *keys, const Quat4f *tangents, size_t nKeys,
+                 const float *times, Matrix3f *out, size_t n);
+
+#ifdef VECMATH_HEADER_ONLY
+#include "BatchInterpolate.cpp"
+#endif
+
+#endif // BATCH_INTERPOLATE_H
@@ -0,0 +1,141 @@
+#include "BatchTransform.h"
+
+#include "Affine3f.h"
+#include "Matrix3f.h"
+#include "Matrix4f.h"
+#include "Vector3f.h"
+#include "vecmath_kernels.h"
+
+namespace vecmath_detail {
+
+// The top three rows of an affine transform, row-major: out = R * (v, 1).
+struct BatchRows {
+    float r[3][4];
+};
+
+inline BatchRows batchRows(const Matrix4f &m, bool translate) {
+    BatchRows rows;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            rows.r[i][j] = m(i, j);
+        }
+        rows.r[i][3] = translate ? m(i, 3) : 0.f;
+    }
+    return rows;
+}
+
+inline BatchRows batchRows(const Matrix3f &m) {
+    BatchRows rows;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            rows.r[i][j] = m(i, j);
+        }
+        rows.r[i][3] = 0.f;
+    }
+    return rows;
+}
+
+inline BatchRows batchRows(const Affine3f &a, bool translate) {
+    BatchRows rows = batchRows(a.getLinear());
+    if (translate) {
+        for (int i = 0; i < 3; ++i) {
+            rows.r[i][3] = a.getTranslation()[i];
+        }
+    }
+    return rows;
+}
+
+inline void batchTransformOne(const BatchRows &m, float x, float y, float z,
+                              float &outX, float &outY, float &outZ) {
+    outX = m.r[0][0] * x + m.r[0][1] * y + m.r[0][2] * z + m.r[0][3];
+    outY = m.r[1][0] * x + m.r[1][1] * y + m.r[1][2] * z + m.r[1][3];
+    outZ = m.r[2][0] * x + m.r[2][1] * y + m.r[2][2] * z + m.r[2][3];
+}
+
+inline void batchTransformAoS(const BatchRows &m, const Vector3f *in,
+                              Vector3f *out, size_t n) {
+#ifdef VECMATH_SSE
+    simdKernels().transformAoS(&m.r[0][0],
+                               reinterpret_cast<const float *>(in),
+                               reinterpret_cast<float *>(out), n);
+#else
+    for (size_t i = 0; i < n; ++i) {
+        Vector3f v = in[i];
+        batchTransformOne(m, v[0], v[1], v[2], out[i][0], out[i][1],
+                          out[i][2]);
+    }
+#endif
+}
+
+inline void batchTransformSoA(const BatchRows &m, const float *x,
+                              const float *y, const float *z, float *outX,
+                              float *outY, float *outZ, size_t n) {
+#ifdef VECMATH_SSE
+    simdKernels().transformSoA(&m.r[0][0], x, y, z, outX, outY, outZ, n);
+#else
+    for (size_t i = 0; i < n; ++i) {
+        float vx = x[i], vy = y[i], vz = z[i];
+        batchTransformOne(m, vx, vy, vz, outX[i], outY[i], outZ[i]);
+    }
+#endif
+}
+
+} // namespace vecmath_detail
+
+VECMATH_INLINE void transformPoints(const Matrix4f &m, const Vector3f *in,
+                                    Vector3f *out, size_t n) {
+    vecmath_detail::batchTransformAoS(vecmath_detail::batchRows(m, true), in,
+                                      out, n);
+}
+
+VECMATH_INLINE void transformDirections(const Matrix4f &m, const Vector3f *in,
+                                        Vector3f *out, size_t n) {
+    vecmath_detail::batchTransformAoS(vecmath_detail::batchRows(m, false), in,
+                                      out, n);
+}
+
+VECMATH_INLINE void transformNormals(const Matrix4f &m, const Vector3f *in,
+                                     Vector3f *out, size_t n) {
+    Matrix3f normalMatrix = m.getSubmatrix3x3(0, 0).inverse().transposed();
+    vecmath_detail::batchTransformAoS(
+        vecmath_detail::batchRows(normalMatrix), in, out, n);
+}
+
+VECMATH_INLINE void transform(const Matrix3f &m, const Vector3f *in,
+                              Vector3f *out, size_t n) {
+    vecmath_detail::batchTransformAoS(vecmath_detail::batchRows(m), in, out, n);
+}
+
+VECMATH_INLINE void transformPoints(const Affine3f &a, const Vector3f *in,
+                                    Vector3f *out, size_t n) {
+    vecmath_detail::batchTransformAoS(vecmath_detail::batchRows(a, true), in,
+                                      out, n);
+}
+
+VECMATH_INLINE void transformDirections(const Affine3f &a, const Vector3f *in,
+                                        Vector3f *out, size_t n) {
+    vecmath_detail::batchTransformAoS(vecmath_detail::batchRows(a, false), in,
+                                      out, n);
+}
+
+VECMATH_INLINE void transformNormals(const Affine3f &a, const Vector3f *in,
+                                     Vector3f *out, size_t n) {
+    vecmath_detail::batchTransformAoS(
+        vecmath_detail::batchRows(a.normalMatrix()), in, out, n);
+}
+
+VECMATH_INLINE void transformPoints(const Matrix4f &m, const float *x,
+                                    const float *y, const float *z,
+                                    float *outX, float *outY, float *outZ,
+                                    size_t n) {
+    vecmath_detail::batchTransformSoA(vecmath_detail::batchRows(m, true), x,
+                                      y, z, outX, outY, outZ, n);
+}
+
+VECMATH_INLINE void transformDirections(const Matrix4f &m, const float *x,
+                                        const float *y, const float *z,
+                                        float *outX, float *outY, float *outZ,
+                                        size_t n) {
+    vecmath_detail::batchTransformSoA(vecmath_detail::batchRows(m, false), x,
+                                      y, z, outX, outY, outZ, n);
+}
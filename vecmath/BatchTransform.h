@@ -0,0 +1,58 @@
+#ifndef BATCH_TRANSFORM_H
+#define BATCH_TRANSFORM_H
+
+#include "vecmath_config.h"
+
+#include <cstddef>
+
+class Affine3f;
+class Matrix3f;
+class Matrix4f;
+class Vector3f;
+
+// Batched transforms of arrays of 3D vectors by a single matrix.
+//
+// These are equivalent to calling (m * Vector4f(v, 1)).xyz() (or the w = 0 /
+// Matrix3f variants) on each element, but load the matrix once and run at
+// SIMD width.  The AoS functions take arrays of Vector3f; the SoA functions
+// take separate x, y and z arrays.  In every function "in" and "out" may be
+// the same array, but must not otherwise overlap.
+
+// out[i] = m * (in[i], 1), dropping w.  m is assumed to be affine.
+void transformPoints(const Matrix4f &m, const Vector3f *in, Vector3f *out,
+                     size_t n);
+
+// out[i] = m * (in[i], 0), i.e. only the upper 3x3 of m is applied.
+void transformDirections(const Matrix4f &m, const Vector3f *in, Vector3f *out,
+                         size_t n);
+
+// out[i] = transpose(inverse(M)) * in[i], where M is the upper 3x3 of m.
+// The results are not renormalized.
+void transformNormals(const Matrix4f &m, const Vector3f *in, Vector3f *out,
+                      size_t n);
+
+// out[i] = m * in[i]
+void transform(const Matrix3f &m, const Vector3f *in, Vector3f *out,
+               size_t n);
+
+// Affine3f versions of the above.
+void transformPoints(const Affine3f &a, const Vector3f *in, Vector3f *out,
+                     size_t n);
+void transformDirections(const Affine3f &a, const Vector3f *in, Vector3f *out,
+                         size_t n);
+void transformNormals(const Affine3f &a, const Vector3f *in, Vector3f *out,
+                      size_t n);
+
+// SoA variants of transformPoints and transformDirections.
+void transformPoints(const Matrix4f &m, const float *x, const float *y,
+                     const float *z, float *outX, float *outY, float *outZ,
+                     size_t n);
+void transformDirections(const Matrix4f &m, const float *x, const float *y,
+                         const float *z, float *outX, float *outY, float *outZ,
+                         size_t n);
+
+#ifdef VECMATH_HEADER_ONLY
+#include "BatchTransform.cpp"
+#endif
+
+#endif // BATCH_TRANSFORM_H
@@ -0,0 +1,81 @@
+#include "BatchTrig.h"
+
+#include "vecmath_simd.h"
+
+#include <cmath>
+
+VECMATH_INLINE void sinCos(const float *radians, float *s, float *c,
+                           size_t n) {
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= n; i += 4) {
+        __m128 sin4;
+        __m128 cos4;
+        simdSinCos(_mm_loadu_ps(radians + i), sin4, cos4);
+        _mm_storeu_ps(s + i, sin4);
+        _mm_storeu_ps(c + i, cos4);
+    }
+#endif
+
+    for (; i < n; ++i) {
+        s[i] = std::sin(radians[i]);
+        c[i] = std::cos(radians[i]);
+    }
+}
+
+VECMATH_INLINE void sinCosSteps(float start, float step, float *s, float *c,
+                                size_t n) {
+    double a = start;
+    double d = step;
+    double sinA = std::sin(a);
+    double cosA = std::cos(a);
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    if (n >= 4) {
+        // four interleaved recurrences stepping by 4 * step, lane j at
+        // start + (4 k + j) * step, so consecutive updates don't wait on
+        // each other
+        __m128d stepS = _mm_set1_pd(std::sin(4 * d));
+        __m128d stepC = _mm_set1_pd(std::cos(4 * d));
+        __m128d sin01 = _mm_setr_pd(sinA, std::sin(a + d));
+        __m128d cos01 = _mm_setr_pd(cosA, std::cos(a + d));
+        __m128d sin23 = _mm_setr_pd(std::sin(a + 2 * d), std::sin(a + 3 * d));
+        __m128d cos23 = _mm_setr_pd(std::cos(a + 2 * d), std::cos(a + 3 * d));
+
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(s + i, _mm_movelh_ps(_mm_cvtpd_ps(sin01),
+                                               _mm_cvtpd_ps(sin23)));
+            _mm_storeu_ps(c + i, _mm_movelh_ps(_mm_cvtpd_ps(cos01),
+                                               _mm_cvtpd_ps(cos23)));
+
+            __m128d next01 = _mm_add_pd(_mm_mul_pd(sin01, stepC),
+                                        _mm_mul_pd(cos01, stepS));
+            cos01 = _mm_sub_pd(_mm_mul_pd(cos01, stepC),
+                               _mm_mul_pd(sin01, stepS));
+            sin01 = next01;
+            __m128d next23 = _mm_add_pd(_mm_mul_pd(sin23, stepC),
+                                        _mm_mul_pd(cos23, stepS));
+            cos23 = _mm_sub_pd(_mm_mul_pd(cos23, stepC),
+                               _mm_mul_pd(sin23, stepS));
+            sin23 = next23;
+        }
+
+        // lane 0 is now at start + i * step
+        sinA = _mm_cvtsd_f64(sin01);
+        cosA = _mm_cvtsd_f64(cos01);
+    }
+#endif
+
+    double stepS = std::sin(d);
+    double stepC = std::cos(d);
+    for (; i < n; ++i) {
+        s[i] = static_cast<float>(sinA);
+        c[i] = static_cast<float>(cosA);
+
+        double nextS = sinA * stepC + cosA * stepS;
+        cosA = cosA * stepC - sinA * stepS;
+        sinA = nextS;
+    }
+}
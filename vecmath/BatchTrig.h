@@ -0,0 +1,25 @@
+#ifndef BATCH_TRIG_H
+#define BATCH_TRIG_H
+
+#include "vecmath_config.h"
+
+#include <cstddef>
+
+// Batched sines and cosines, e.g. for the rotations of a sweep.
+
+// s[i] = sin(radians[i]) and c[i] = cos(radians[i]), four at a time with
+// SSE: within about 1e-7 of std::sin and std::cos for |radians| up to a few
+// thousand.
+void sinCos(const float *radians, float *s, float *c, size_t n);
+
+// The same for the angles start + i * step, i = 0 .. n - 1, without any
+// per-step trig: each (cos, sin) pair is the previous one turned by step
+// (angle addition), carried in double so the error stays near float
+// rounding for millions of steps.
+void sinCosSteps(float start, float step, float *s, float *c, size_t n);
+
+#ifdef VECMATH_HEADER_ONLY
+#include "BatchTrig.cpp"
+#endif
+
+#endif // BATCH_TRIG_H
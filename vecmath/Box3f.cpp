@@ -0,0 +1,168 @@
+#include "Box3f.h"
+
+#include "Matrix4f.h"
+#include "vecmath_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+VECMATH_INLINE Vector3f Box3f::center() const {
+    return Vector3f(0.5f * (m_min[0] + m_max[0]), 0.5f * (m_min[1] + m_max[1]),
+                    0.5f * (m_min[2] + m_max[2]));
+}
+
+VECMATH_INLINE Vector3f Box3f::halfExtent() const {
+    return Vector3f(0.5f * (m_max[0] - m_min[0]), 0.5f * (m_max[1] - m_min[1]),
+                    0.5f * (m_max[2] - m_min[2]));
+}
+
+VECMATH_INLINE void Box3f::extend(const Vector3f &p) {
+    for (int i = 0; i < 3; ++i) {
+        m_min[i] = std::min(m_min[i], p[i]);
+        m_max[i] = std::max(m_max[i], p[i]);
+    }
+}
+
+VECMATH_INLINE void Box3f::extend(const Box3f &b) {
+    for (int i = 0; i < 3; ++i) {
+        m_min[i] = std::min(m_min[i], b.m_min[i]);
+        m_max[i] = std::max(m_max[i], b.m_max[i]);
+    }
+}
+
+VECMATH_INLINE bool Box3f::contains(const Vector3f &p) const {
+    return m_min[0] <= p[0] && p[0] <= m_max[0] && m_min[1] <= p[1] &&
+           p[1] <= m_max[1] && m_min[2] <= p[2] && p[2] <= m_max[2];
+}
+
+VECMATH_INLINE bool Box3f::overlaps(const Box3f &b) const {
+    return m_min[0] <= b.m_max[0] && b.m_min[0] <= m_max[0] &&
+           m_min[1] <= b.m_max[1] && b.m_min[1] <= m_max[1] &&
+           m_min[2] <= b.m_max[2] && b.m_min[2] <= m_max[2];
+}
+
+VECMATH_INLINE Box3f Box3f::transformed(const Matrix4f &m) const {
+    if (isEmpty()) {
+        return *this;
+    }
+
+    // the new center is m * center; each new half extent sums the old ones
+    // weighted by the absolute values of m's rows
+    Vector3f c = center();
+    Vector3f h = halfExtent();
+    Vector3f newC;
+    Vector3f newH;
+    for (int i = 0; i < 3; ++i) {
+        newC[i] = m(i, 0) * c[0] + m(i, 1) * c[1] + m(i, 2) * c[2] + m(i, 3);
+        newH[i] = std::fabs(m(i, 0)) * h[0] + std::fabs(m(i, 1)) * h[1] +
+                  std::fabs(m(i, 2)) * h[2];
+    }
+    return Box3f(newC - newH, newC + newH);
+}
+
+VECMATH_INLINE bool Box3f::intersectRay(const Vector3f &origin,
+                                        const Vector3f &direction,
+                                        float *tNear, float *tFar) const {
+    if (isEmpty()) {
+        return false;
+    }
+
+    const float inf = std::numeric_limits<float>::infinity();
+    float t0;
+    float t1;
+
+#ifdef VECMATH_SSE
+    // the unused fourth lane is the slab (-inf, inf)
+    __m128 o = _mm_setr_ps(origin[0], origin[1], origin[2], 0.f);
+    __m128 invD = _mm_div_ps(
+        _mm_set1_ps(1.f),
+        _mm_setr_ps(direction[0], direction[1], direction[2], 1.f));
+    __m128 lo = _mm_mul_ps(
+        _mm_sub_ps(_mm_setr_ps(m_min[0], m_min[1], m_min[2], -inf), o), invD);
+    __m128 hi = _mm_mul_ps(
+        _mm_sub_ps(_mm_setr_ps(m_max[0], m_max[1], m_max[2], inf), o), invD);
+
+    // 0 * inf: the ray runs inside a face plane, which counts as in the slab
+    __m128 onFace = _mm_cmpunord_ps(lo, hi);
+    __m128 enter = _mm_min_ps(lo, hi);
+    __m128 leave = _mm_max_ps(lo, hi);
+    enter = _mm_or_ps(_mm_and_ps(onFace, _mm_set1_ps(-inf)),
+                      _mm_andnot_ps(onFace, enter));
+    leave = _mm_or_ps(_mm_and_ps(onFace, _mm_set1_ps(inf)),
+                      _mm_andnot_ps(onFace, leave));
+
+    t0 = std::max(simdHMax(enter), 0.f);
+    t1 = simdHMin(leave);
+#else
+    t0 = 0.f;
+    t1 = inf;
+    for (int i = 0; i < 3; ++i) {
+        float invD = 1.f / direction[i];
+        float lo = (m_min[i] - origin[i]) * invD;
+        float hi = (m_max[i] - origin[i]) * invD;
+        if (std::isnan(lo) || std::isnan(hi)) {
+            continue;
+        }
+        t0 = std::max(t0, std::min(lo, hi));
+        t1 = std::min(t1, std::max(lo, hi));
+    }
+#endif
+
+    if (!(t0 <= t1)) {
+        return false;
+    }
+    if (tNear != NULL) {
+        *tNear = t0;
+    }
+    if (tFar != NULL) {
+        *tFar = t1;
+    }
+    return true;
+}
+
+VECMATH_INLINE void Box3f::print() const {
+    printf("[ %.4f %.4f %.4f ] - [ %.4f %.4f %.4f ]\n", m_min[0], m_min[1],
+           m_min[2], m_max[0], m_max[1], m_max[2]);
+}
+
+// static
+VECMATH_INLINE Box3f Box3f::fromPoints(const Vector3f *points, size_t n) {
+    Box3f box;
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    if (n >= 4) {
+        const float inf = std::numeric_limits<float>::infinity();
+        __m128 minX = _mm_set1_ps(inf);
+        __m128 minY = minX;
+        __m128 minZ = minX;
+        __m128 maxX = _mm_set1_ps(-inf);
+        __m128 maxY = maxX;
+        __m128 maxZ = maxX;
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 x;
+            __m128 y;
+            __m128 z;
+            simdLoadVector3fx4(&points[i][0], x, y, z);
+            // the accumulator is the second operand, so NaNs are skipped
+            minX = _mm_min_ps(x, minX);
+            minY = _mm_min_ps(y, minY);
+            minZ = _mm_min_ps(z, minZ);
+            maxX = _mm_max_ps(x, maxX);
+            maxY = _mm_max_ps(y, maxY);
+            maxZ = _mm_max_ps(z, maxZ);
+        }
+
+        box = Box3f(Vector3f(simdHMin(minX), simdHMin(minY), simdHMin(minZ)),
+                    Vector3f(simdHMax(maxX), simdHMax(maxY), simdHMax(maxZ)));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        box.extend(points[i]);
+    }
+    return box;
+}
@@ -0,0 +1,83 @@
+#ifndef BOX3F_H
+#define BOX3F_H
+
+#include "vecmath_config.h"
+
+#include "Vector3f.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <type_traits>
+
+class Matrix4f;
+
+// Axis-aligned bounding box [min, max].  The default box is empty (min = +inf,
+// max = -inf), so that extending it by anything gives that thing's bounds.
+class Box3f {
+  public:
+    // empty
+    constexpr Box3f()
+        : m_min(std::numeric_limits<float>::infinity()),
+          m_max(-std::numeric_limits<float>::infinity()) {}
+    constexpr Box3f(const Vector3f &min, const Vector3f &max)
+        : m_min(min), m_max(max) {}
+
+    // implicit copy constructor and assignment operator (trivially copyable)
+    // no destructor necessary
+
+    constexpr const Vector3f &getMin() const { return m_min; }
+    constexpr const Vector3f &getMax() const { return m_max; }
+
+    constexpr bool isEmpty() const {
+        return !(m_min[0] <= m_max[0] && m_min[1] <= m_max[1] &&
+                 m_min[2] <= m_max[2]);
+    }
+
+    // (min + max) / 2 and (max - min) / 2
+    Vector3f center() const;
+    Vector3f halfExtent() const;
+
+    void extend(const Vector3f &p);
+    void extend(const Box3f &b);
+
+    // inclusive of the faces
+    bool contains(const Vector3f &p) const;
+    bool overlaps(const Box3f &b) const;
+
+    // Bounds of this box transformed by m, which is assumed to be affine
+    // (Arvo's method: no corners are transformed).
+    Box3f transformed(const Matrix4f &m) const;
+
+    // Slab test of the ray origin + t * direction, t >= 0.  On a hit returns
+    // true and the parameters where the ray enters and leaves the box (tNear
+    // is 0 if the origin is inside).  direction need not be unit length, and
+    // may have zero components.
+    bool intersectRay(const Vector3f &origin, const Vector3f &direction,
+                      float *tNear = NULL, float *tFar = NULL) const;
+
+    // ---- Utility ----
+    void print() const;
+
+    // The bounds of n points, in one pass at SIMD width.  NaN coordinates
+    // are ignored, as by extend.
+    static Box3f fromPoints(const Vector3f *points, size_t n);
+
+  private:
+    Vector3f m_min;
+    Vector3f m_max;
+};
+
+static_assert(std::is_trivially_copyable<Box3f>::value,
+              "Box3f must be trivially copyable");
+static_assert(std::is_standard_layout<Box3f>::value &&
+                  sizeof(Box3f) == 6 * sizeof(float),
+              "Box3f must be laid out as 6 packed floats");
+static_assert(Box3f().isEmpty() && !Box3f(Vector3f(0), Vector3f(0)).isEmpty(),
+              "Box3f must be usable in constant expressions");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Box3f.cpp"
+#endif
+
+#endif // BOX3F_H
@@ -0,0 +1,135 @@
+#include "Frustum.h"
+
+#include "Box3f.h"
+#include "Matrix4f.h"
+#include "Sphere3f.h"
+#include "Vector3f.h"
+#include "Vector4f.h"
+#include "vecmath_simd.h"
+
+#include <cmath>
+
+VECMATH_INLINE Frustum::Frustum(const Matrix4f &m, bool directX) {
+    // Gribb and Hartmann: each clip inequality, e.g. -w <= x, is a plane
+    // (row 3 + row 0) . (p, 1) >= 0 in the space m is applied to
+    Vector4f x = m.getRow(0);
+    Vector4f y = m.getRow(1);
+    Vector4f z = m.getRow(2);
+    Vector4f w = m.getRow(3);
+    Vector4f planes[6] = {w + x, w - x, w + y, w - y, directX ? z : w + z,
+                          w - z};
+
+    for (int i = 0; i < 8; ++i) {
+        Vector4f plane = planes[i % 6];
+        float length = plane.xyz().abs();
+        if (length > 0.f) {
+            plane = plane / length;
+        }
+        for (int k = 0; k < 4; ++k) {
+            m_planes[k][i] = plane[k];
+        }
+    }
+}
+
+VECMATH_INLINE Vector4f Frustum::getPlane(int i) const {
+    return Vector4f(m_planes[0][i], m_planes[1][i], m_planes[2][i],
+                    m_planes[3][i]);
+}
+
+VECMATH_INLINE bool Frustum::contains(const Vector3f &p) const {
+    for (int i = 0; i < 6; ++i) {
+        if (m_planes[0][i] * p[0] + m_planes[1][i] * p[1] +
+                m_planes[2][i] * p[2] + m_planes[3][i] <
+            0.f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+VECMATH_INLINE bool Frustum::intersects(const Box3f &b) const {
+    if (b.isEmpty()) {
+        return false;
+    }
+
+    // Test the corner of b furthest along each plane's normal: if even that
+    // one is outside, so is all of b.
+#ifdef VECMATH_SSE
+    __m128 minX = _mm_set1_ps(b.getMin()[0]);
+    __m128 minY = _mm_set1_ps(b.getMin()[1]);
+    __m128 minZ = _mm_set1_ps(b.getMin()[2]);
+    __m128 maxX = _mm_set1_ps(b.getMax()[0]);
+    __m128 maxY = _mm_set1_ps(b.getMax()[1]);
+    __m128 maxZ = _mm_set1_ps(b.getMax()[2]);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (int i = 0; i < 8; i += 4) {
+        __m128 nx = _mm_load_ps(m_planes[0] + i);
+        __m128 ny = _mm_load_ps(m_planes[1] + i);
+        __m128 nz = _mm_load_ps(m_planes[2] + i);
+        __m128 d = _mm_load_ps(m_planes[3] + i);
+
+        __m128 px = _mm_cmpge_ps(nx, zero);
+        __m128 py = _mm_cmpge_ps(ny, zero);
+        __m128 pz = _mm_cmpge_ps(nz, zero);
+        px = _mm_or_ps(_mm_and_ps(px, maxX), _mm_andnot_ps(px, minX));
+        py = _mm_or_ps(_mm_and_ps(py, maxY), _mm_andnot_ps(py, minY));
+        pz = _mm_or_ps(_mm_and_ps(pz, maxZ), _mm_andnot_ps(pz, minZ));
+
+        __m128 distance = simdMadd(nx, px, d);
+        distance = simdMadd(ny, py, distance);
+        distance = simdMadd(nz, pz, distance);
+        if (_mm_movemask_ps(_mm_cmplt_ps(distance, zero)) != 0) {
+            return false;
+        }
+    }
+    return true;
+#else
+    for (int i = 0; i < 6; ++i) {
+        float distance = m_planes[3][i];
+        for (int k = 0; k < 3; ++k) {
+            float n = m_planes[k][i];
+            distance += n * (n >= 0.f ? b.getMax()[k] : b.getMin()[k]);
+        }
+        if (distance < 0.f) {
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+VECMATH_INLINE bool Frustum::intersects(const Sphere3f &s) const {
+    if (s.isEmpty()) {
+        return false;
+    }
+
+    const Vector3f &c = s.getCenter();
+
+#ifdef VECMATH_SSE
+    __m128 cx = _mm_set1_ps(c[0]);
+    __m128 cy = _mm_set1_ps(c[1]);
+    __m128 cz = _mm_set1_ps(c[2]);
+    __m128 minusR = _mm_set1_ps(-s.getRadius());
+
+    for (int i = 0; i < 8; i += 4) {
+        __m128 distance = simdMadd(_mm_load_ps(m_planes[0] + i), cx,
+                                   _mm_load_ps(m_planes[3] + i));
+        distance = simdMadd(_mm_load_ps(m_planes[1] + i), cy, distance);
+        distance = simdMadd(_mm_load_ps(m_planes[2] + i), cz, distance);
+        if (_mm_movemask_ps(_mm_cmplt_ps(distance, minusR)) != 0) {
+            return false;
+        }
+    }
+    return true;
+#else
+    for (int i = 0; i < 6; ++i) {
+        float distance = m_planes[0][i] * c[0] + m_planes[1][i] * c[1] +
+                         m_planes[2][i] * c[2] + m_planes[3][i];
+        if (distance < -s.getRadius()) {
+            return false;
+        }
+    }
+    return true;
+#endif
+}
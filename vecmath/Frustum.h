@@ -0,0 +1,53 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "vecmath_config.h"
+
+#include <type_traits>
+
+class Box3f;
+class Matrix4f;
+class Sphere3f;
+class Vector3f;
+class Vector4f;
+
+// The view volume of a projection, as six planes.  Built from a projection
+// or view-projection matrix, it culls bounds given in the space that matrix
+// is applied to (e.g. world space for projection * view).
+class Frustum {
+  public:
+    // The points p whose clip coordinates m * (p, 1) have -w <= x, y <= w and
+    // -w <= z <= w, or 0 <= z <= w when directX, matching the directX flag
+    // of Matrix4f::perspectiveProjection and orthographicProjection.
+    explicit Frustum(const Matrix4f &m, bool directX = false);
+
+    // implicit copy constructor and assignment operator (trivially copyable)
+    // no destructor necessary
+
+    // Plane i (left, right, bottom, top, near, far) as (n, d) with n unit
+    // length: p is on the inner side when dot(n, p) + d >= 0.  The far plane
+    // of an infinite projection is (0, 0, 0, d) with d > 0.
+    Vector4f getPlane(int i) const;
+
+    bool contains(const Vector3f &p) const;
+
+    // Conservative tests: false only when b or s is entirely outside one of
+    // the planes, so bounds near a corner of the frustum may pass.  Empty
+    // bounds never intersect.
+    bool intersects(const Box3f &b) const;
+    bool intersects(const Sphere3f &s) const;
+
+  private:
+    // m_planes[k][i] is component k (x, y, z, d) of plane i; lanes 6 and 7
+    // repeat planes 0 and 1 so the planes fill two SIMD registers
+    alignas(16) float m_planes[4][8];
+};
+
+static_assert(std::is_trivially_copyable<Frustum>::value,
+              "Frustum must be trivially copyable");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Frustum.cpp"
+#endif
+
+#endif // FRUSTUM_H
@@ -0,0 +1,131 @@
+#ifndef MAT_H
+#define MAT_H
+
+#include "vecmath_config.h"
+
+#include "Matrix4f.h"
+#include "Vec.h"
+
+#include <cmath>
+#include <type_traits>
+
+// NxN matrix of T, stored in column major order like Matrix3f/4f, for the
+// rotations that float rounding spoils: Mat3d spreads a1's closed-curve
+// twist and Mat4d composes the arcball's rotations in double.  Mat4d
+// converts to and from Matrix4f with toMat and toMatrix4f; everything else
+// uses the float classes.
+template <typename T, int N> class Mat {
+    static_assert(N >= 1, "Mat needs at least one row");
+
+  public:
+    static constexpr int size = N;
+
+    // fill with 0
+    constexpr Mat() : m_elements{} {}
+
+    // implicit copy constructor and assignment operator (trivially copyable
+    // for trivially copyable T)
+    // no destructor necessary
+
+    constexpr const T &operator()(int i, int j) const {
+        return m_elements[j * N + i];
+    }
+    constexpr T &operator()(int i, int j) { return m_elements[j * N + i]; }
+
+    static constexpr Mat identity() {
+        Mat m;
+        for (int i = 0; i < N; ++i) {
+            m(i, i) = T(1);
+        }
+        return m;
+    }
+
+    // Rotation about rDirection by radians, in the upper left 3x3 (the rest
+    // of the identity for N = 4), as in Matrix3f::rotation.
+    static Mat rotation(const Vec<T, 3> &rDirection, T radians) {
+        return rotation(rDirection, std::cos(radians), std::sin(radians));
+    }
+
+    // the same, from a precomputed cosine and sine
+    static Mat rotation(const Vec<T, 3> &rDirection, T c, T s) {
+        static_assert(N == 3 || N == 4, "rotation needs N = 3 or 4");
+
+        Vec<T, 3> direction = rDirection.normalized();
+        T x = direction[0];
+        T y = direction[1];
+        T z = direction[2];
+
+        Mat m = identity();
+        m(0, 0) = x * x * (1 - c) + c;
+        m(0, 1) = y * x * (1 - c) - z * s;
+        m(0, 2) = z * x * (1 - c) + y * s;
+        m(1, 0) = x * y * (1 - c) + z * s;
+        m(1, 1) = y * y * (1 - c) + c;
+        m(1, 2) = z * y * (1 - c) - x * s;
+        m(2, 0) = x * z * (1 - c) - y * s;
+        m(2, 1) = y * z * (1 - c) + x * s;
+        m(2, 2) = z * z * (1 - c) + c;
+        return m;
+    }
+
+  private:
+    T m_elements[N * N];
+};
+
+// Matrix-Vector multiplication
+template <typename T, int N>
+constexpr Vec<T, N> operator*(const Mat<T, N> &m, const Vec<T, N> &v) {
+    Vec<T, N> out;
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            out[i] += m(i, j) * v[j];
+        }
+    }
+    return out;
+}
+
+// Matrix-Matrix multiplication
+template <typename T, int N>
+constexpr Mat<T, N> operator*(const Mat<T, N> &x, const Mat<T, N> &y) {
+    Mat<T, N> product;
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            for (int k = 0; k < N; ++k) {
+                product(i, k) += x(i, j) * y(j, k);
+            }
+        }
+    }
+    return product;
+}
+
+using Mat3d = Mat<double, 3>;
+using Mat4d = Mat<double, 4>;
+
+// Conversions to and from Matrix4f, e.g. toMat<double>(m)
+template <typename T> Mat<T, 4> toMat(const Matrix4f &m) {
+    Mat<T, 4> out;
+    for (int j = 0; j < 4; ++j) {
+        for (int i = 0; i < 4; ++i) {
+            out(i, j) = m(i, j);
+        }
+    }
+    return out;
+}
+
+template <typename T> Matrix4f toMatrix4f(const Mat<T, 4> &m) {
+    Matrix4f out;
+    for (int j = 0; j < 4; ++j) {
+        for (int i = 0; i < 4; ++i) {
+            out(i, j) = static_cast<float>(m(i, j));
+        }
+    }
+    return out;
+}
+
+static_assert(std::is_trivially_copyable<Mat4d>::value &&
+                  sizeof(Mat4d) == 16 * sizeof(double),
+              "Mat4d must be laid out as 16 packed doubles");
+static_assert(Mat3d::identity()(2, 2) == 1,
+              "Mat must be usable in constant expressions");
+
+#endif // MAT_H
@@ -1,7 +1,10 @@
 #ifndef MATRIX2F_H
 #define MATRIX2F_H
 
+#include "vecmath_config.h"
+
 #include <cstdio>
+#include <type_traits>
 
 class Vector2f;
 
@@ -9,19 +12,21 @@ class Vector2f;
 class Matrix2f {
   public:
     // Fill a 2x2 matrix with "fill", default to 0.
-    Matrix2f(float fill = 0.f);
-    Matrix2f(float m00, float m01, float m10, float m11);
+    constexpr Matrix2f(float fill = 0.f) : m_elements{fill, fill, fill, fill} {}
+    constexpr Matrix2f(float m00, float m01, float m10, float m11)
+        : m_elements{m00, m10, m01, m11} {}
 
     // setColumns = true ==> sets the columns of the matrix to be [v0 v1]
     // otherwise, sets the rows
     Matrix2f(const Vector2f &v0, const Vector2f &v1, bool setColumns = true);
 
-    Matrix2f(const Matrix2f &rm);            // copy constructor
-    Matrix2f &operator=(const Matrix2f &rm); // assignment operator
+    // implicit copy constructor and assignment operator (trivially copyable)
     // no destructor necessary
 
-    const float &operator()(int i, int j) const;
-    float &operator()(int i, int j);
+    constexpr const float &operator()(int i, int j) const {
+        return m_elements[j * 2 + i];
+    }
+    constexpr float &operator()(int i, int j) { return m_elements[j * 2 + i]; }
 
     Vector2f getRow(int i) const;
     void setRow(int i, const Vector2f &v);
@@ -39,7 +44,10 @@ class Matrix2f {
     operator float *(); // automatic type conversion for GL
     void print();
 
-    static float determinant2x2(float m00, float m01, float m10, float m11);
+    static constexpr float determinant2x2(float m00, float m01, float m10,
+                                          float m11) {
+        return (m00 * m11 - m01 * m10);
+    }
 
     static Matrix2f ones();
     static Matrix2f identity();
@@ -60,4 +68,16 @@ Vector2f operator*(const Matrix2f &m, const Vector2f &v);
 // Matrix-Matrix multiplication
 Matrix2f operator*(const Matrix2f &x, const Matrix2f &y);
 
+static_assert(std::is_trivially_copyable<Matrix2f>::value,
+              "Matrix2f must be trivially copyable");
+static_assert(std::is_standard_layout<Matrix2f>::value &&
+                  sizeof(Matrix2f) == 4 * sizeof(float),
+              "Matrix2f must be laid out as 4 packed floats");
+static_assert(Matrix2f(1, 2, 3, 4)(0, 1) == 2,
+              "Matrix2f must be usable in constant expressions");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Matrix2f.cpp"
+#endif
+
 #endif // MATRIX2F_H
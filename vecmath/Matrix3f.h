@@ -1,7 +1,12 @@
 #ifndef MATRIX3F_H
 #define MATRIX3F_H
 
+#include "vecmath_config.h"
+
+#include <cmath>
+#include <cstddef>
 #include <cstdio>
+#include <type_traits>
 
 class Matrix2f;
 class Quat4f;
@@ -11,21 +16,27 @@ class Vector3f;
 class Matrix3f {
   public:
     // Fill a 3x3 matrix with "fill", default to 0.
-    Matrix3f(float fill = 0.f);
-    Matrix3f(float m00, float m01, float m02, float m10, float m11, float m12,
-             float m20, float m21, float m22);
+    constexpr Matrix3f(float fill = 0.f) : m_elements{} {
+        for (int i = 0; i < 9; ++i) {
+            m_elements[i] = fill;
+        }
+    }
+    constexpr Matrix3f(float m00, float m01, float m02, float m10, float m11,
+                       float m12, float m20, float m21, float m22)
+        : m_elements{m00, m10, m20, m01, m11, m21, m02, m12, m22} {}
 
     // setColumns = true ==> sets the columns of the matrix to be [v0 v1 v2]
     // otherwise, sets the rows
     Matrix3f(const Vector3f &v0, const Vector3f &v1, const Vector3f &v2,
              bool setColumns = true);
 
-    Matrix3f(const Matrix3f &rm);            // copy constructor
-    Matrix3f &operator=(const Matrix3f &rm); // assignment operator
+    // implicit copy constructor and assignment operator (trivially copyable)
     // no destructor necessary
 
-    const float &operator()(int i, int j) const;
-    float &operator()(int i, int j);
+    constexpr const float &operator()(int i, int j) const {
+        return m_elements[j * 3 + i];
+    }
+    constexpr float &operator()(int i, int j) { return m_elements[j * 3 + i]; }
 
     Vector3f getRow(int i) const;
     void setRow(int i, const Vector3f &v);
@@ -47,23 +58,70 @@ class Matrix3f {
             float epsilon = 0.f) const; // TODO: invert in place as well
 
     void transpose();
-    Matrix3f transposed() const;
+    constexpr Matrix3f transposed() const;
+
+    // true if the columns are unit length and mutually perpendicular, each
+    // within epsilon, i.e. if transposed() * (*this) is the identity
+    bool isOrthonormal(float epsilon = 1e-4f) const;
+
+    // transpose(inverse(M)) for an orthonormal M, which is M itself.  The
+    // cofactor inverse is skipped; VECMATH_DEBUG builds check
+    // isOrthonormal().
+    Matrix3f inverseTransposeOrthonormal() const;
 
     // ---- Utility ----
     operator float *(); // automatic type conversion for GL
     void print();
 
-    static float determinant3x3(float m00, float m01, float m02, float m10,
-                                float m11, float m12, float m20, float m21,
-                                float m22);
-
-    static Matrix3f ones();
-    static Matrix3f identity();
+    static constexpr float determinant3x3(float m00, float m01, float m02,
+                                         float m10, float m11, float m12,
+                                         float m20, float m21, float m22) {
+        return (m00 * (m11 * m22 - m12 * m21) - m01 * (m10 * m22 - m12 * m20) +
+                m02 * (m10 * m21 - m11 * m20));
+    }
+
+    static constexpr Matrix3f ones() { return Matrix3f(1); }
+    static constexpr Matrix3f identity() {
+        return Matrix3f(1, 0, 0, 0, 1, 0, 0, 0, 1);
+    }
     static Matrix3f rotateX(float radians);
     static Matrix3f rotateY(float radians);
     static Matrix3f rotateZ(float radians);
-    static Matrix3f scaling(float sx, float sy, float sz);
-    static Matrix3f uniformScaling(float s);
+
+    // the same rotations, built from a precomputed cosine and sine; named
+    // apart so that a dropped argument can't pick the other meaning
+    static constexpr Matrix3f rotateXCosSin(float c, float s) {
+        return Matrix3f(1, 0, 0, 0, c, -s, 0, s, c);
+    }
+    static constexpr Matrix3f rotateYCosSin(float c, float s) {
+        return Matrix3f(c, 0, s, 0, 1, 0, -s, 0, c);
+    }
+    static constexpr Matrix3f rotateZCosSin(float c, float s) {
+        return Matrix3f(c, -s, 0, s, c, 0, 0, 0, 1);
+    }
+
+    // Batches of the same rotations: out[i] turns by radians[i] (sines and
+    // cosines from sinCos), or by start + i * step (from sinCosSteps, with
+    // no per-step trig)
+    static void rotationsAboutX(const float *radians, Matrix3f *out,
+                                size_t n);
+    static void rotationsAboutY(const float *radians, Matrix3f *out,
+                                size_t n);
+    static void rotationsAboutZ(const float *radians, Matrix3f *out,
+                                size_t n);
+    static void rotationsAboutX(float start, float step, Matrix3f *out,
+                                size_t n);
+    static void rotationsAboutY(float start, float step, Matrix3f *out,
+                                size_t n);
+    static void rotationsAboutZ(float start, float step, Matrix3f *out,
+                                size_t n);
+
+    static constexpr Matrix3f scaling(float sx, float sy, float sz) {
+        return Matrix3f(sx, 0, 0, 0, sy, 0, 0, 0, sz);
+    }
+    static constexpr Matrix3f uniformScaling(float s) {
+        return Matrix3f(s, 0, 0, 0, s, 0, 0, 0, s);
+    }
     static Matrix3f rotation(const Vector3f &rDirection, float radians);
 
     // Returns the rotation matrix represented by a unit quaternion
@@ -81,4 +139,84 @@ Vector3f operator*(const Matrix3f &m, const Vector3f &v);
 // Matrix-Matrix multiplication
 Matrix3f operator*(const Matrix3f &x, const Matrix3f &y);
 
+// The inverse and transpose are defined here, so that they, and Affine3f's
+// compose and inverse built on them, inline without VECMATH_HEADER_ONLY.
+// Matrix2f does not depend on Matrix3f, so it can be completed here.
+#include "Matrix2f.h"
+
+inline Matrix3f Matrix3f::inverse(bool *pbIsSingular, float epsilon) const {
+    float m00 = m_elements[0];
+    float m10 = m_elements[1];
+    float m20 = m_elements[2];
+
+    float m01 = m_elements[3];
+    float m11 = m_elements[4];
+    float m21 = m_elements[5];
+
+    float m02 = m_elements[6];
+    float m12 = m_elements[7];
+    float m22 = m_elements[8];
+
+    float cofactor00 = Matrix2f::determinant2x2(m11, m12, m21, m22);
+    float cofactor01 = -Matrix2f::determinant2x2(m10, m12, m20, m22);
+    float cofactor02 = Matrix2f::determinant2x2(m10, m11, m20, m21);
+
+    float cofactor10 = -Matrix2f::determinant2x2(m01, m02, m21, m22);
+    float cofactor11 = Matrix2f::determinant2x2(m00, m02, m20, m22);
+    float cofactor12 = -Matrix2f::determinant2x2(m00, m01, m20, m21);
+
+    float cofactor20 = Matrix2f::determinant2x2(m01, m02, m11, m12);
+    float cofactor21 = -Matrix2f::determinant2x2(m00, m02, m10, m12);
+    float cofactor22 = Matrix2f::determinant2x2(m00, m01, m10, m11);
+
+    float determinant = m00 * cofactor00 + m01 * cofactor01 + m02 * cofactor02;
+
+    bool isSingular = (std::fabs(determinant) < epsilon);
+    if (isSingular) {
+        if (pbIsSingular != NULL) {
+            *pbIsSingular = true;
+        }
+        return Matrix3f();
+    } else {
+        if (pbIsSingular != NULL) {
+            *pbIsSingular = false;
+        }
+
+        float reciprocalDeterminant = 1.0f / determinant;
+
+        return Matrix3f(cofactor00 * reciprocalDeterminant,
+                        cofactor10 * reciprocalDeterminant,
+                        cofactor20 * reciprocalDeterminant,
+                        cofactor01 * reciprocalDeterminant,
+                        cofactor11 * reciprocalDeterminant,
+                        cofactor21 * reciprocalDeterminant,
+                        cofactor02 * reciprocalDeterminant,
+                        cofactor12 * reciprocalDeterminant,
+                        cofactor22 * reciprocalDeterminant);
+    }
+}
+
+constexpr Matrix3f Matrix3f::transposed() const {
+    Matrix3f out;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            out(j, i) = (*this)(i, j);
+        }
+    }
+
+    return out;
+}
+
+static_assert(std::is_trivially_copyable<Matrix3f>::value,
+              "Matrix3f must be trivially copyable");
+static_assert(std::is_standard_layout<Matrix3f>::value &&
+                  sizeof(Matrix3f) == 9 * sizeof(float),
+              "Matrix3f must be laid out as 9 packed floats");
+static_assert(Matrix3f::identity()(2, 2) == 1,
+              "Matrix3f must be usable in constant expressions");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Matrix3f.cpp"
+#endif
+
 #endif // MATRIX3F_H
@@ -5,52 +5,20 @@
 #include "Quat4f.h"
 #include "Vector3f.h"
 #include "Vector4f.h"
+#include "vecmath_kernels.h"
 
 #include <cassert>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
 
-Matrix4f::Matrix4f(float fill) {
-    for (int i = 0; i < 16; ++i) {
-        m_elements[i] = fill;
-    }
-}
-
-Matrix4f::Matrix4f(float m00, float m01, float m02, float m03, float m10,
-                   float m11, float m12, float m13, float m20, float m21,
-                   float m22, float m23, float m30, float m31, float m32,
-                   float m33) {
-    m_elements[0] = m00;
-    m_elements[1] = m10;
-    m_elements[2] = m20;
-    m_elements[3] = m30;
-
-    m_elements[4] = m01;
-    m_elements[5] = m11;
-    m_elements[6] = m21;
-    m_elements[7] = m31;
-
-    m_elements[8] = m02;
-    m_elements[9] = m12;
-    m_elements[10] = m22;
-    m_elements[11] = m32;
-
-    m_elements[12] = m03;
-    m_elements[13] = m13;
-    m_elements[14] = m23;
-    m_elements[15] = m33;
-}
-
-Matrix4f &Matrix4f::operator/=(float d) {
-    for (int ii = 0; ii < 16; ii++) {
-        m_elements[ii] /= d;
-    }
-    return *this;
-}
+#ifdef VECMATH_SSE
+#include <immintrin.h>
+#endif
 
-Matrix4f::Matrix4f(const Vector4f &v0, const Vector4f &v1, const Vector4f &v2,
-                   const Vector4f &v3, bool setColumns) {
+VECMATH_INLINE Matrix4f::Matrix4f(const Vector4f &v0, const Vector4f &v1,
+                                  const Vector4f &v2, const Vector4f &v3,
+                                  bool setColumns) {
     if (setColumns) {
         setCol(0, v0);
         setCol(1, v1);
@@ -64,43 +32,26 @@ Matrix4f::Matrix4f(const Vector4f &v0, const Vector4f &v1, const Vector4f &v2,
     }
 }
 
-Matrix4f::Matrix4f(const Matrix4f &rm) {
-    memcpy(m_elements, rm.m_elements, 16 * sizeof(float));
-}
-
-Matrix4f &Matrix4f::operator=(const Matrix4f &rm) {
-    if (this != &rm) {
-        memcpy(m_elements, rm.m_elements, 16 * sizeof(float));
-    }
-    return *this;
-}
-
-const float &Matrix4f::operator()(int i, int j) const {
-    return m_elements[j * 4 + i];
-}
-
-float &Matrix4f::operator()(int i, int j) { return m_elements[j * 4 + i]; }
-
-Vector4f Matrix4f::getRow(int i) const {
+VECMATH_INLINE Vector4f Matrix4f::getRow(int i) const {
     return Vector4f(m_elements[i], m_elements[i + 4], m_elements[i + 8],
                     m_elements[i + 12]);
 }
 
-void Matrix4f::setRow(int i, const Vector4f &v) {
+VECMATH_INLINE void Matrix4f::setRow(int i, const Vector4f &v) {
     m_elements[i] = v.x();
     m_elements[i + 4] = v.y();
     m_elements[i + 8] = v.z();
     m_elements[i + 12] = v.w();
 }
 
-Vector4f Matrix4f::getCol(int j) const {
+VECMATH_INLINE Vector4f Matrix4f::getCol(int j) const {
     int colStart = 4 * j;
 
     return Vector4f(m_elements[colStart], m_elements[colStart + 1],
                     m_elements[colStart + 2], m_elements[colStart + 3]);
 }
 
-void Matrix4f::setCol(int j, const Vector4f &v) {
+VECMATH_INLINE void Matrix4f::setCol(int j, const Vector4f &v) {
     int colStart = 4 * j;
 
     m_elements[colStart] = v.x();
@@ -109,7 +60,7 @@ void Matrix4f::setCol(int j, const Vector4f &v) {
     m_elements[colStart + 3] = v.w();
 }
 
-Matrix2f Matrix4f::getSubmatrix2x2(int i0, int j0) const {
+VECMATH_INLINE Matrix2f Matrix4f::getSubmatrix2x2(int i0, int j0) const {
     Matrix2f out;
 
     for (int i = 0; i < 2; ++i) {
@@ -121,7 +72,7 @@ Matrix2f Matrix4f::getSubmatrix2x2(int i0, int j0) const {
     return out;
 }
 
-Matrix3f Matrix4f::getSubmatrix3x3(int i0, int j0) const {
+VECMATH_INLINE Matrix3f Matrix4f::getSubmatrix3x3(int i0, int j0) const {
     Matrix3f out;
 
     for (int i = 0; i < 3; ++i) {
@@ -133,7 +84,8 @@ Matrix3f Matrix4f::getSubmatrix3x3(int i0, int j0) const {
     return out;
 }
 
-void Matrix4f::setSubmatrix2x2(int i0, int j0, const Matrix2f &m) {
+VECMATH_INLINE void Matrix4f::setSubmatrix2x2(int i0, int j0,
+                                              const Matrix2f &m) {
     for (int i = 0; i < 2; ++i) {
         for (int j = 0; j < 2; ++j) {
             (*this)(i + i0, j + j0) = m(i, j);
@@ -141,7 +93,8 @@ void Matrix4f::setSubmatrix2x2(int i0, int j0, const Matrix2f &m) {
     }
 }
 
-void Matrix4f::setSubmatrix3x3(int i0, int j0, const Matrix3f &m) {
+VECMATH_INLINE void Matrix4f::setSubmatrix3x3(int i0, int j0,
+                                              const Matrix3f &m) {
     for (int i = 0; i < 3; ++i) {
         for (int j = 0; j < 3; ++j) {
             (*this)(i + i0, j + j0) = m(i, j);
@@ -149,7 +102,7 @@ void Matrix4f::setSubmatrix3x3(int i0, int j0, const Matrix3f &m) {
     }
 }
 
-float Matrix4f::determinant() const {
+VECMATH_INLINE float Matrix4f::determinant() const {
     float m00 = m_elements[0];
     float m10 = m_elements[1];
     float m20 = m_elements[2];
@@ -183,7 +136,25 @@ float Matrix4f::determinant() const {
             m03 * cofactor03);
 }
 
-Matrix4f Matrix4f::inverse(bool *pbIsSingular, float epsilon) const {
+VECMATH_INLINE Matrix4f Matrix4f::inverse(bool *pbIsSingular,
+                                          float epsilon) const {
+#ifdef VECMATH_SSE
+    Matrix4f out;
+    // the kernel's determinant, summed from its 2x2 minors: it can differ
+    // from determinant() in the last bits, which matters only for matrices
+    // within rounding of epsilon
+    float determinant =
+        simdKernels().inverse4x4(m_elements, out.m_elements);
+
+    bool isSingular = (fabs(determinant) < epsilon);
+    if (pbIsSingular != NULL) {
+        *pbIsSingular = isSingular;
+    }
+    if (isSingular) {
+        return Matrix4f();
+    }
+    return out;
+#else
     float m00 = m_elements[0];
     float m10 = m_elements[1];
     float m20 = m_elements[2];
@@ -273,9 +244,10 @@ Matrix4f Matrix4f::inverse(bool *pbIsSingular, float epsilon) const {
                         cofactor23 * reciprocalDeterminant,
                         cofactor33 * reciprocalDeterminant);
     }
+#endif
 }
 
-void Matrix4f::transpose() {
+VECMATH_INLINE void Matrix4f::transpose() {
     float temp;
 
     for (int i = 0; i < 3; ++i) {
@@ -287,7 +259,7 @@ void Matrix4f::transpose() {
     }
 }
 
-Matrix4f Matrix4f::transposed() const {
+VECMATH_INLINE Matrix4f Matrix4f::transposed() const {
     Matrix4f out;
     for (int i = 0; i < 4; ++i) {
         for (int j = 0; j < 4; ++j) {
@@ -298,11 +270,11 @@ Matrix4f Matrix4f::transposed() const {
     return out;
 }
 
-Matrix4f::operator float *() { return m_elements; }
+VECMATH_INLINE Matrix4f::operator float *() { return m_elements; }
 
-Matrix4f::operator const float *() const { return m_elements; }
+VECMATH_INLINE Matrix4f::operator const float *() const { return m_elements; }
 
-void Matrix4f::print() {
+VECMATH_INLINE void Matrix4f::print() {
     printf("[ %.4f %.4f %.4f %.4f ]\n[ %.4f %.4f %.4f %.4f ]\n[ %.4f %.4f %.4f "
            "%.4f ]\n[ %.4f %.4f %.4f %.4f ]\n",
            m_elements[0], m_elements[4], m_elements[8], m_elements[12],
@@ -312,40 +284,13 @@ void Matrix4f::print() {
 }
 
 // static
-Matrix4f Matrix4f::ones() {
-    Matrix4f m;
-    for (int i = 0; i < 16; ++i) {
-        m.m_elements[i] = 1;
-    }
-
-    return m;
-}
-
-// static
-Matrix4f Matrix4f::identity() {
-    Matrix4f m;
-
-    m(0, 0) = 1;
-    m(1, 1) = 1;
-    m(2, 2) = 1;
-    m(3, 3) = 1;
-
-    return m;
-}
-
-// static
-Matrix4f Matrix4f::translation(float x, float y, float z) {
-    return Matrix4f(1, 0, 0, x, 0, 1, 0, y, 0, 0, 1, z, 0, 0, 0, 1);
-}
-
-// static
-Matrix4f Matrix4f::translation(const Vector3f &rTranslation) {
+VECMATH_INLINE Matrix4f Matrix4f::translation(const Vector3f &rTranslation) {
     return Matrix4f(1, 0, 0, rTranslation.x(), 0, 1, 0, rTranslation.y(), 0, 0,
                     1, rTranslation.z(), 0, 0, 0, 1);
 }
 
 // static
-Matrix4f Matrix4f::rotateX(float radians) {
+VECMATH_INLINE Matrix4f Matrix4f::rotateX(float radians) {
     float c = cos(radians);
     float s = sin(radians);
 
@@ -353,7 +298,7 @@ Matrix4f Matrix4f::rotateX(float radians) {
 }
 
 // static
-Matrix4f Matrix4f::rotateY(float radians) {
+VECMATH_INLINE Matrix4f Matrix4f::rotateY(float radians) {
     float c = cos(radians);
     float s = sin(radians);
 
@@ -361,7 +306,7 @@ Matrix4f Matrix4f::rotateY(float radians) {
 }
 
 // static
-Matrix4f Matrix4f::rotateZ(float radians) {
+VECMATH_INLINE Matrix4f Matrix4f::rotateZ(float radians) {
     float c = cos(radians);
     float s = sin(radians);
 
@@ -369,7 +314,8 @@ Matrix4f Matrix4f::rotateZ(float radians) {
 }
 
 // static
-Matrix4f Matrix4f::rotation(const Vector3f &rDirection, float radians) {
+VECMATH_INLINE Matrix4f Matrix4f::rotation(const Vector3f &rDirection,
+                                           float radians) {
     Vector3f normalizedDirection = rDirection.normalized();
 
     float cosTheta = cos(radians);
@@ -392,7 +338,7 @@ Matrix4f Matrix4f::rotation(const Vector3f &rDirection, float radians) {
 }
 
 // static
-Matrix4f Matrix4f::rotation(const Quat4f &q) {
+VECMATH_INLINE Matrix4f Matrix4f::rotation(const Quat4f &q) {
     Quat4f qq = q.normalized();
 
     float xx = qq.x() * qq.x();
@@ -415,23 +361,14 @@ Matrix4f Matrix4f::rotation(const Quat4f &q) {
 }
 
 // static
-Matrix4f Matrix4f::scaling(float sx, float sy, float sz) {
-    return Matrix4f(sx, 0, 0, 0, 0, sy, 0, 0, 0, 0, sz, 0, 0, 0, 0, 1);
-}
-
-// static
-Matrix4f Matrix4f::uniformScaling(float s) {
-    return Matrix4f(s, 0, 0, 0, 0, s, 0, 0, 0, 0, s, 0, 0, 0, 0, 1);
-}
-
-// static
-Matrix4f Matrix4f::randomRotation(float u0, float u1, float u2) {
+VECMATH_INLINE Matrix4f Matrix4f::randomRotation(float u0, float u1, float u2) {
     return Matrix4f::rotation(Quat4f::randomRotation(u0, u1, u2));
 }
 
 // static
-Matrix4f Matrix4f::lookAt(const Vector3f &eye, const Vector3f &center,
-                          const Vector3f &up) {
+VECMATH_INLINE Matrix4f Matrix4f::lookAt(const Vector3f &eye,
+                                         const Vector3f &center,
+                                         const Vector3f &up) {
     // z is negative forward
     Vector3f z = (eye - center).normalized();
     Vector3f y = up;
@@ -450,9 +387,11 @@ Matrix4f Matrix4f::lookAt(const Vector3f &eye, const Vector3f &center,
 }
 
 // static
-Matrix4f Matrix4f::orthographicProjection(float width, float height,
-                                          float zNear, float zFar,
-                                          bool directX) {
+VECMATH_INLINE Matrix4f Matrix4f::orthographicProjection(float width,
+                                                         float height,
+                                                         float zNear,
+                                                         float zFar,
+                                                         bool directX) {
     Matrix4f m;
 
     m(0, 0) = 2.0f / width;
@@ -474,9 +413,12 @@ Matrix4f Matrix4f::orthographicProjection(float width, float height,
 }
 
 // static
-Matrix4f Matrix4f::orthographicProjection(float left, float right, float bottom,
-                                          float top, float zNear, float zFar,
-                                          bool directX) {
+VECMATH_INLINE Matrix4f Matrix4f::orthographicProjection(float left,
+                                                         float right,
+                                                         float bottom,
+                                                         float top, float zNear,
+                                                         float zFar,
+                                                         bool directX) {
     Matrix4f m;
 
     m(0, 0) = 2.0f / (right - left);
@@ -498,10 +440,13 @@ Matrix4f Matrix4f::orthographicProjection(float left, float right, float bottom,
 }
 
 // static
-Matrix4f Matrix4f::perspectiveProjection(float fLeft, float fRight,
-                                         float fBottom, float fTop,
-                                         float fZNear, float fZFar,
-                                         bool directX) {
+VECMATH_INLINE Matrix4f Matrix4f::perspectiveProjection(float fLeft,
+                                                        float fRight,
+                                                        float fBottom,
+                                                        float fTop,
+                                                        float fZNear,
+                                                        float fZFar,
+                                                        bool directX) {
     Matrix4f projection; // zero matrix
 
     projection(0, 0) = (2.0f * fZNear) / (fRight - fLeft);
@@ -522,9 +467,10 @@ Matrix4f Matrix4f::perspectiveProjection(float fLeft, float fRight,
 }
 
 // static
-Matrix4f Matrix4f::perspectiveProjection(float fovYRadians, float aspect,
-                                         float zNear, float zFar,
-                                         bool directX) {
+VECMATH_INLINE Matrix4f Matrix4f::perspectiveProjection(float fovYRadians,
+                                                        float aspect,
+                                                        float zNear, float zFar,
+                                                        bool directX) {
     Matrix4f m; // zero matrix
 
     float yScale = 1.f / tanf(0.5f * fovYRadians);
@@ -546,9 +492,12 @@ Matrix4f Matrix4f::perspectiveProjection(float fovYRadians, float aspect,
 }
 
 // static
-Matrix4f Matrix4f::infinitePerspectiveProjection(float fLeft, float fRight,
-                                                 float fBottom, float fTop,
-                                                 float fZNear, bool directX) {
+VECMATH_INLINE Matrix4f Matrix4f::infinitePerspectiveProjection(float fLeft,
+                                                                float fRight,
+                                                                float fBottom,
+                                                                float fTop,
+                                                                float fZNear,
+                                                                bool directX) {
     Matrix4f projection;
 
     projection(0, 0) = (2.0f * fZNear) / (fRight - fLeft);
@@ -574,21 +523,39 @@ Matrix4f Matrix4f::infinitePerspectiveProjection(float fLeft, float fRight,
 // Operators
 //////////////////////////////////////////////////////////////////////////
 
-Vector4f operator*(const Matrix4f &m, const Vector4f &v) {
+VECMATH_INLINE Vector4f operator*(const Matrix4f &m, const Vector4f &v) {
     Vector4f output(0, 0, 0, 0);
 
+#ifdef VECMATH_SSE
+    // output = sum_j column_j * v[j]
+    const float *e = m;
+    __m128 sum = _mm_mul_ps(_mm_loadu_ps(e), _mm_set1_ps(v[0]));
+    for (int j = 1; j < 4; ++j) {
+#ifdef VECMATH_FMA
+        sum = _mm_fmadd_ps(_mm_loadu_ps(e + 4 * j), _mm_set1_ps(v[j]), sum);
+#else
+        sum = _mm_add_ps(
+            sum, _mm_mul_ps(_mm_loadu_ps(e + 4 * j), _mm_set1_ps(v[j])));
+#endif
+    }
+    _mm_storeu_ps(output, sum);
+#else
     for (int i = 0; i < 4; ++i) {
         for (int j = 0; j < 4; ++j) {
             output[i] += m(i, j) * v[j];
         }
     }
+#endif
 
     return output;
 }
 
-Matrix4f operator*(const Matrix4f &x, const Matrix4f &y) {
+VECMATH_INLINE Matrix4f operator*(const Matrix4f &x, const Matrix4f &y) {
     Matrix4f product; // zeroes
 
+#ifdef VECMATH_SSE
+    simdKernels().multiply4x4(x, y, product);
+#else
     for (int i = 0; i < 4; ++i) {
         for (int j = 0; j < 4; ++j) {
             for (int k = 0; k < 4; ++k) {
@@ -596,6 +563,7 @@ Matrix4f operator*(const Matrix4f &x, const Matrix4f &y) {
             }
         }
     }
+#endif
 
     return product;
 }
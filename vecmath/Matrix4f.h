@@ -1,7 +1,10 @@
 #ifndef MATRIX4F_H
 #define MATRIX4F_H
 
+#include "vecmath_config.h"
+
 #include <cstdio>
+#include <type_traits>
 
 class Matrix2f;
 class Matrix3f;
@@ -13,23 +16,37 @@ class Vector4f;
 class Matrix4f {
   public:
     // Fill a 4x4 matrix with "fill".  Default to 0.
-    Matrix4f(float fill = 0.f);
-    Matrix4f(float m00, float m01, float m02, float m03, float m10, float m11,
-             float m12, float m13, float m20, float m21, float m22, float m23,
-             float m30, float m31, float m32, float m33);
+    constexpr Matrix4f(float fill = 0.f) : m_elements{} {
+        for (int i = 0; i < 16; ++i) {
+            m_elements[i] = fill;
+        }
+    }
+    constexpr Matrix4f(float m00, float m01, float m02, float m03, float m10,
+                       float m11, float m12, float m13, float m20, float m21,
+                       float m22, float m23, float m30, float m31, float m32,
+                       float m33)
+        : m_elements{m00, m10, m20, m30, m01, m11, m21, m31,
+                     m02, m12, m22, m32, m03, m13, m23, m33} {}
 
     // setColumns = true ==> sets the columns of the matrix to be [v0 v1 v2 v3]
     // otherwise, sets the rows
     Matrix4f(const Vector4f &v0, const Vector4f &v1, const Vector4f &v2,
              const Vector4f &v3, bool setColumns = true);
 
-    Matrix4f(const Matrix4f &rm);            // copy constructor
-    Matrix4f &operator=(const Matrix4f &rm); // assignment operator
-    Matrix4f &operator/=(float d);
+    // implicit copy constructor and assignment operator (trivially copyable)
     // no destructor necessary
 
-    const float &operator()(int i, int j) const;
-    float &operator()(int i, int j);
+    constexpr Matrix4f &operator/=(float d) {
+        for (int i = 0; i < 16; ++i) {
+            m_elements[i] /= d;
+        }
+        return *this;
+    }
+
+    constexpr const float &operator()(int i, int j) const {
+        return m_elements[j * 4 + i];
+    }
+    constexpr float &operator()(int i, int j) { return m_elements[j * 4 + i]; }
 
     Vector4f getRow(int i) const;
     void setRow(int i, const Vector4f &v);
@@ -60,22 +77,48 @@ class Matrix4f {
     void transpose();
     Matrix4f transposed() const;
 
+    // (*this * Vector4f(p, 1)).xyz() and (*this * Vector4f(d, 0)).xyz(),
+    // without the Vector4f temporaries
+    constexpr Vector3f transformPoint(const Vector3f &p) const;
+    constexpr Vector3f transformDirection(const Vector3f &d) const;
+
     // ---- Utility ----
     operator float *();             // automatic type conversion for GL
     operator const float *() const; // automatic type conversion for GL
 
     void print();
 
-    static Matrix4f ones();
-    static Matrix4f identity();
-    static Matrix4f translation(float x, float y, float z);
+    static constexpr Matrix4f ones() { return Matrix4f(1); }
+    static constexpr Matrix4f identity() {
+        return Matrix4f(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+    }
+    static constexpr Matrix4f translation(float x, float y, float z) {
+        return Matrix4f(1, 0, 0, x, 0, 1, 0, y, 0, 0, 1, z, 0, 0, 0, 1);
+    }
     static Matrix4f translation(const Vector3f &rTranslation);
     static Matrix4f rotateX(float radians);
     static Matrix4f rotateY(float radians);
     static Matrix4f rotateZ(float radians);
+
+    // the same rotations, built from a precomputed cosine and sine; named
+    // apart so that a dropped argument can't pick the other meaning
+    static constexpr Matrix4f rotateXCosSin(float c, float s) {
+        return Matrix4f(1, 0, 0, 0, 0, c, -s, 0, 0, s, c, 0, 0, 0, 0, 1);
+    }
+    static constexpr Matrix4f rotateYCosSin(float c, float s) {
+        return Matrix4f(c, 0, s, 0, 0, 1, 0, 0, -s, 0, c, 0, 0, 0, 0, 1);
+    }
+    static constexpr Matrix4f rotateZCosSin(float c, float s) {
+        return Matrix4f(c, -s, 0, 0, s, c, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+    }
+
     static Matrix4f rotation(const Vector3f &rDirection, float radians);
-    static Matrix4f scaling(float sx, float sy, float sz);
-    static Matrix4f uniformScaling(float s);
+    static constexpr Matrix4f scaling(float sx, float sy, float sz) {
+        return Matrix4f(sx, 0, 0, 0, 0, sy, 0, 0, 0, 0, sz, 0, 0, 0, 0, 1);
+    }
+    static constexpr Matrix4f uniformScaling(float s) {
+        return Matrix4f(s, 0, 0, 0, 0, s, 0, 0, 0, 0, s, 0, 0, 0, 0, 1);
+    }
     static Matrix4f lookAt(const Vector3f &eye, const Vector3f &center,
                            const Vector3f &up);
     static Matrix4f orthographicProjection(float width, float height,
@@ -114,4 +157,34 @@ Vector4f operator*(const Matrix4f &m, const Vector4f &v);
 // Matrix-Matrix multiplication
 Matrix4f operator*(const Matrix4f &x, const Matrix4f &y);
 
+// Vector3f does not depend on Matrix4f, so it can be completed here for the
+// constexpr members above.
+#include "Vector3f.h"
+
+constexpr Vector3f Matrix4f::transformPoint(const Vector3f &p) const {
+    const Matrix4f &m = *this;
+    return Vector3f(m(0, 0) * p[0] + m(0, 1) * p[1] + m(0, 2) * p[2] + m(0, 3),
+                    m(1, 0) * p[0] + m(1, 1) * p[1] + m(1, 2) * p[2] + m(1, 3),
+                    m(2, 0) * p[0] + m(2, 1) * p[1] + m(2, 2) * p[2] + m(2, 3));
+}
+
+constexpr Vector3f Matrix4f::transformDirection(const Vector3f &d) const {
+    const Matrix4f &m = *this;
+    return Vector3f(m(0, 0) * d[0] + m(0, 1) * d[1] + m(0, 2) * d[2],
+                    m(1, 0) * d[0] + m(1, 1) * d[1] + m(1, 2) * d[2],
+                    m(2, 0) * d[0] + m(2, 1) * d[1] + m(2, 2) * d[2]);
+}
+
+static_assert(std::is_trivially_copyable<Matrix4f>::value,
+              "Matrix4f must be trivially copyable");
+static_assert(std::is_standard_layout<Matrix4f>::value &&
+                  sizeof(Matrix4f) == 16 * sizeof(float),
+              "Matrix4f must be laid out as 16 packed floats");
+static_assert(Matrix4f::translation(1, 2, 3)(2, 3) == 3,
+              "Matrix4f must be usable in constant expressions");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Matrix4f.cpp"
+#endif
+
 #endif // MATRIX4F_H
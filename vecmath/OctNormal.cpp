@@ -0,0 +1,239 @@
+#include "OctNormal.h"
+
+#include "Vector3f.h"
+#include "vecmath_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vecmath_detail {
+
+// the snorm scales of the two encodings
+constexpr float octScale32 = 32767.f;
+constexpr float octScale16 = 127.f;
+
+// n projected onto the octahedron, lower half folded over the upper: a point
+// of [-1, 1]^2.  Each step is spelled out to match octEncodeX4 exactly.
+inline void octEncode(const Vector3f &n, float &u, float &v) {
+    float l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+    l1 = std::max(l1, std::numeric_limits<float>::min());
+    u = n[0] / l1;
+    v = n[1] / l1;
+    if (n[2] < 0.f) {
+        float foldU = (1.f - std::fabs(v)) * (u >= 0.f ? 1.f : -1.f);
+        float foldV = (1.f - std::fabs(u)) * (v >= 0.f ? 1.f : -1.f);
+        u = foldU;
+        v = foldV;
+    }
+}
+
+// |x / l1| <= 1 holds after rounding too, so no clamp is needed
+inline int octQuantize(float u, float scale) {
+    return static_cast<int>(std::nearbyint(u * scale));
+}
+
+// the inverse of octEncode, normalized
+inline Vector3f octDecode(float u, float v) {
+    u = std::max(u, -1.f);
+    v = std::max(v, -1.f);
+    float z = 1.f - std::fabs(u) - std::fabs(v);
+    // unfold: t is 0 on the upper half
+    float t = std::max(-z, 0.f);
+    u -= u >= 0.f ? t : -t;
+    v -= v >= 0.f ? t : -t;
+#ifdef VECMATH_FMA
+    // contracted the same way as octDecodeX4
+    float norm = std::sqrt(std::fma(z, z, std::fma(v, v, u * u)));
+#else
+    float norm = std::sqrt(u * u + v * v + z * z);
+#endif
+    return Vector3f(u / norm, v / norm, z / norm);
+}
+
+#ifdef VECMATH_SSE
+inline __m128 octAbs(__m128 x) { return _mm_andnot_ps(_mm_set1_ps(-0.f), x); }
+
+// the sign bit where !(a >= 0): xor by it multiplies by a >= 0 ? 1 : -1
+inline __m128 octSign(__m128 a) {
+    return _mm_andnot_ps(_mm_cmpge_ps(a, _mm_setzero_ps()),
+                         _mm_set1_ps(-0.f));
+}
+
+inline void octEncodeX4(__m128 x, __m128 y, __m128 z, __m128 &u, __m128 &v) {
+    __m128 l1 = _mm_add_ps(_mm_add_ps(octAbs(x), octAbs(y)), octAbs(z));
+    l1 = _mm_max_ps(l1, _mm_set1_ps(std::numeric_limits<float>::min()));
+    u = _mm_div_ps(x, l1);
+    v = _mm_div_ps(y, l1);
+
+    __m128 one = _mm_set1_ps(1.f);
+    __m128 foldU = _mm_sub_ps(one, octAbs(v));
+    __m128 foldV = _mm_sub_ps(one, octAbs(u));
+    foldU = _mm_xor_ps(foldU, octSign(u));
+    foldV = _mm_xor_ps(foldV, octSign(v));
+
+    __m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+    u = _mm_or_ps(_mm_and_ps(lower, foldU), _mm_andnot_ps(lower, u));
+    v = _mm_or_ps(_mm_and_ps(lower, foldV), _mm_andnot_ps(lower, v));
+}
+
+inline void octDecodeX4(__m128 u, __m128 v, __m128 &x, __m128 &y,
+                        __m128 &z) {
+    u = _mm_max_ps(u, _mm_set1_ps(-1.f));
+    v = _mm_max_ps(v, _mm_set1_ps(-1.f));
+    z = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.f), octAbs(u)), octAbs(v));
+    __m128 t = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps());
+    u = _mm_sub_ps(u, _mm_xor_ps(t, octSign(u)));
+    v = _mm_sub_ps(v, _mm_xor_ps(t, octSign(v)));
+
+    __m128 norm2 = _mm_mul_ps(u, u);
+    norm2 = simdMadd(v, v, norm2);
+    norm2 = simdMadd(z, z, norm2);
+    __m128 norm = _mm_sqrt_ps(norm2);
+    x = _mm_div_ps(u, norm);
+    y = _mm_div_ps(v, norm);
+    z = _mm_div_ps(z, norm);
+}
+#endif
+
+} // namespace vecmath_detail
+
+VECMATH_INLINE OctNormal32::OctNormal32(const Vector3f &n) {
+    float u;
+    float v;
+    vecmath_detail::octEncode(n, u, v);
+    m_x = static_cast<int16_t>(
+        vecmath_detail::octQuantize(u, vecmath_detail::octScale32));
+    m_y = static_cast<int16_t>(
+        vecmath_detail::octQuantize(v, vecmath_detail::octScale32));
+}
+
+VECMATH_INLINE OctNormal32::operator Vector3f() const {
+    const float scale = 1.f / vecmath_detail::octScale32;
+    return vecmath_detail::octDecode(m_x * scale, m_y * scale);
+}
+
+VECMATH_INLINE OctNormal16::OctNormal16(const Vector3f &n) {
+    float u;
+    float v;
+    vecmath_detail::octEncode(n, u, v);
+    m_x = static_cast<int8_t>(
+        vecmath_detail::octQuantize(u, vecmath_detail::octScale16));
+    m_y = static_cast<int8_t>(
+        vecmath_detail::octQuantize(v, vecmath_detail::octScale16));
+}
+
+VECMATH_INLINE OctNormal16::operator Vector3f() const {
+    const float scale = 1.f / vecmath_detail::octScale16;
+    return vecmath_detail::octDecode(m_x * scale, m_y * scale);
+}
+
+VECMATH_INLINE void encodeNormals(const Vector3f *in, OctNormal32 *out,
+                                  size_t n) {
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    __m128 scale = _mm_set1_ps(vecmath_detail::octScale32);
+    for (; i + 4 <= n; i += 4) {
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        __m128 u;
+        __m128 v;
+        simdLoadVector3fx4(&in[i][0], x, y, z);
+        vecmath_detail::octEncodeX4(x, y, z, u, v);
+        __m128i qu = _mm_cvtps_epi32(_mm_mul_ps(u, scale));
+        __m128i qv = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+        // each 32-bit lane is one OctNormal32, x in the low half
+        __m128i packed = _mm_or_si128(_mm_and_si128(qu, _mm_set1_epi32(0xffff)),
+                                      _mm_slli_epi32(qv, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = OctNormal32(in[i]);
+    }
+}
+
+VECMATH_INLINE void encodeNormals(const Vector3f *in, OctNormal16 *out,
+                                  size_t n) {
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    __m128 scale = _mm_set1_ps(vecmath_detail::octScale16);
+    for (; i + 4 <= n; i += 4) {
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        __m128 u;
+        __m128 v;
+        simdLoadVector3fx4(&in[i][0], x, y, z);
+        vecmath_detail::octEncodeX4(x, y, z, u, v);
+        __m128i qu = _mm_cvtps_epi32(_mm_mul_ps(u, scale));
+        __m128i qv = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+        // y * 256 + (x & 0xff) lies in [-32512, 32767], so the saturating
+        // pack to 16 bits is exact
+        __m128i packed = _mm_or_si128(_mm_and_si128(qu, _mm_set1_epi32(0xff)),
+                                      _mm_slli_epi32(qv, 8));
+        packed = _mm_packs_epi32(packed, packed);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i), packed);
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = OctNormal16(in[i]);
+    }
+}
+
+VECMATH_INLINE void decodeNormals(const OctNormal32 *in, Vector3f *out,
+                                  size_t n) {
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    __m128 scale = _mm_set1_ps(1.f / vecmath_detail::octScale32);
+    for (; i + 4 <= n; i += 4) {
+        __m128i packed =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        __m128i qu = _mm_srai_epi32(_mm_slli_epi32(packed, 16), 16);
+        __m128i qv = _mm_srai_epi32(packed, 16);
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        vecmath_detail::octDecodeX4(_mm_mul_ps(_mm_cvtepi32_ps(qu), scale),
+                    _mm_mul_ps(_mm_cvtepi32_ps(qv), scale), x, y, z);
+        simdStoreVector3fx4(&out[i][0], x, y, z);
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = static_cast<Vector3f>(in[i]);
+    }
+}
+
+VECMATH_INLINE void decodeNormals(const OctNormal16 *in, Vector3f *out,
+                                  size_t n) {
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    __m128 scale = _mm_set1_ps(1.f / vecmath_detail::octScale16);
+    for (; i + 4 <= n; i += 4) {
+        __m128i packed =
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in + i));
+        // one OctNormal16 in the high half of each 32-bit lane
+        packed = _mm_unpacklo_epi16(_mm_setzero_si128(), packed);
+        __m128i qu = _mm_srai_epi32(_mm_slli_epi32(packed, 8), 24);
+        __m128i qv = _mm_srai_epi32(packed, 24);
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        vecmath_detail::octDecodeX4(_mm_mul_ps(_mm_cvtepi32_ps(qu), scale),
+                    _mm_mul_ps(_mm_cvtepi32_ps(qv), scale), x, y, z);
+        simdStoreVector3fx4(&out[i][0], x, y, z);
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = static_cast<Vector3f>(in[i]);
+    }
+}
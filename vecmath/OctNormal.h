@@ -0,0 +1,77 @@
+#ifndef OCTNORMAL_H
+#define OCTNORMAL_H
+
+#include "vecmath_config.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+class Vector3f;
+
+// Unit vectors stored in octahedral form (Cigolle et al., "A Survey of
+// Efficient Representations for Independent Unit Vectors", JCGT 2014): the
+// direction is projected onto the octahedron |x| + |y| + |z| = 1, the lower
+// half folded over the upper, and the square that results kept as two snorm
+// integers.  Meant for normal buffers; decode to Vector3f to compute.
+//
+// Encoding rounds to the nearest grid point, so the angular error is at most
+// about 0.004 degrees for OctNormal32 and 1 degree for OctNormal16 (see
+// bench).  Decoding always gives a unit vector.  The zero vector encodes as
+// (0, 0, 1), which is also what a default-constructed value decodes to.
+
+// two 16-bit components
+class OctNormal32 {
+  public:
+    constexpr OctNormal32() : m_x(0), m_y(0) {}
+    // n need not be normalized
+    explicit OctNormal32(const Vector3f &n);
+
+    // implicit copy constructor and assignment operator (trivially copyable)
+    // no destructor necessary
+
+    explicit operator Vector3f() const;
+
+    constexpr int16_t x() const { return m_x; }
+    constexpr int16_t y() const { return m_y; }
+
+  private:
+    int16_t m_x;
+    int16_t m_y;
+};
+
+// two 8-bit components
+class OctNormal16 {
+  public:
+    constexpr OctNormal16() : m_x(0), m_y(0) {}
+    explicit OctNormal16(const Vector3f &n);
+
+    explicit operator Vector3f() const;
+
+    constexpr int8_t x() const { return m_x; }
+    constexpr int8_t y() const { return m_y; }
+
+  private:
+    int8_t m_x;
+    int8_t m_y;
+};
+
+// Batched conversions, four vectors at a time with SSE.  The results are the
+// same as converting one at a time.
+void encodeNormals(const Vector3f *in, OctNormal32 *out, size_t n);
+void encodeNormals(const Vector3f *in, OctNormal16 *out, size_t n);
+void decodeNormals(const OctNormal32 *in, Vector3f *out, size_t n);
+void decodeNormals(const OctNormal16 *in, Vector3f *out, size_t n);
+
+static_assert(std::is_trivially_copyable<OctNormal32>::value &&
+                  sizeof(OctNormal32) == 4,
+              "OctNormal32 must be a trivially copyable 32-bit value");
+static_assert(std::is_trivially_copyable<OctNormal16>::value &&
+                  sizeof(OctNormal16) == 2,
+              "OctNormal16 must be a trivially copyable 16-bit value");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "OctNormal.cpp"
+#endif
+
+#endif // OCTNORMAL_H
@@ -1,23 +1,26 @@
 #ifndef QUAT4F_H
 #define QUAT4F_H
 
+#include "vecmath_config.h"
+
+#include <type_traits>
+
+class Matrix3f;
 class Vector3f;
 class Vector4f;
 
-#include "Matrix3f.h"
-
 class Quat4f {
   public:
     static const Quat4f ZERO;
     static const Quat4f IDENTITY;
 
-    Quat4f();
+    constexpr Quat4f() : m_elements{0, 0, 0, 0} {}
 
     // q = w + x * i + y * j + z * k
-    Quat4f(float w, float x, float y, float z);
+    constexpr Quat4f(float w, float x, float y, float z)
+        : m_elements{w, x, y, z} {}
 
-    Quat4f(const Quat4f &rq);            // copy constructor
-    Quat4f &operator=(const Quat4f &rq); // assignment operator
+    // implicit copy constructor and assignment operator (trivially copyable)
     // no destructor necessary
 
     // returns a quaternion with 0 real part
@@ -27,13 +30,13 @@ class Quat4f {
     Quat4f(const Vector4f &v);
 
     // returns the ith element
-    const float &operator[](int i) const;
-    float &operator[](int i);
+    constexpr const float &operator[](int i) const { return m_elements[i]; }
+    constexpr float &operator[](int i) { return m_elements[i]; }
 
-    float w() const;
-    float x() const;
-    float y() const;
-    float z() const;
+    constexpr float w() const { return m_elements[0]; }
+    constexpr float x() const { return m_elements[1]; }
+    constexpr float y() const { return m_elements[2]; }
+    constexpr float z() const { return m_elements[3]; }
     Vector3f xyz() const;
     Vector4f wxyz() const;
 
@@ -68,7 +71,8 @@ class Quat4f {
     // linear (stupid) interpolation
     static Quat4f lerp(const Quat4f &q0, const Quat4f &q1, float alpha);
 
-    // spherical linear interpolation
+    // spherical linear interpolation; with allowFlip, towards whichever of
+    // b and -b is closer to a
     static Quat4f slerp(const Quat4f &a, const Quat4f &b, float t,
                         bool allowFlip = true);
 
@@ -110,4 +114,16 @@ Quat4f operator*(const Quat4f &q0, const Quat4f &q1);
 Quat4f operator*(float f, const Quat4f &q);
 Quat4f operator*(const Quat4f &q, float f);
 
+static_assert(std::is_trivially_copyable<Quat4f>::value,
+              "Quat4f must be trivially copyable");
+static_assert(std::is_standard_layout<Quat4f>::value &&
+                  sizeof(Quat4f) == 4 * sizeof(float),
+              "Quat4f must be laid out as 4 packed floats");
+static_assert(Quat4f(1, 2, 3, 4).z() == 4,
+              "Quat4f must be usable in constant expressions");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Quat4f.cpp"
+#endif
+
 #endif // QUAT4F_H
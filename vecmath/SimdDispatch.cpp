@@ -0,0 +1,142 @@
+#include "SimdDispatch.h"
+
+#include "vecmath_kernels.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(VECMATH_SSE) && !defined(VECMATH_HEADER_ONLY)
+namespace {
+
+// the kernels for level, or NULL if they weren't compiled in
+const SimdKernels *dispatchTable(SimdLevel level) {
+    const SimdKernels &base = simdKernelsBase();
+    if (level == base.level) {
+        return &base;
+    }
+#ifdef VECMATH_DISPATCH
+    // variants narrower than the library's own flags would be no use
+    if (level > base.level) {
+        if (level == SIMD_AVX2) {
+            return &simdKernelsAVX2();
+        }
+        if (level == SIMD_AVX512) {
+            return &simdKernelsAVX512();
+        }
+    }
+#endif
+    return NULL;
+}
+
+bool dispatchCpuSupports(SimdLevel level) {
+    if (level <= simdKernelsBase().level) {
+        // this code is running, so the CPU has the base instruction set
+        return true;
+    }
+#if defined(__GNUC__)
+    // these check that the OS saves the wider registers, too
+    __builtin_cpu_init();
+    bool fma = __builtin_cpu_supports("fma");
+    if (level == SIMD_AVX2) {
+        return fma && __builtin_cpu_supports("avx2");
+    }
+    if (level == SIMD_AVX512) {
+        return fma && __builtin_cpu_supports("avx512f");
+    }
+#endif
+    return false;
+}
+
+// The widest supported level, capped by $VECMATH_SIMD if that names one.
+const SimdKernels *dispatchSelect() {
+    SimdLevel cap = SIMD_AVX512;
+    const char *env = std::getenv("VECMATH_SIMD");
+    if (env != NULL) {
+        for (int level = SIMD_SSE2; level <= SIMD_AVX512; ++level) {
+            if (std::strcmp(env, getSimdLevelName(SimdLevel(level))) == 0) {
+                cap = SimdLevel(level);
+            }
+        }
+    }
+
+    for (int level = cap; level > SIMD_SCALAR; --level) {
+        if (isSimdLevelSupported(SimdLevel(level))) {
+            return dispatchTable(SimdLevel(level));
+        }
+    }
+    // capped below the base level
+    return &simdKernelsBase();
+}
+
+// NULL until the first kernel call; constant-initialized, so kernels may run
+// from other static initializers
+std::atomic<const SimdKernels *> dispatchActive(nullptr);
+
+} // namespace
+
+VECMATH_INLINE const SimdKernels &simdKernels() {
+    const SimdKernels *kernels = dispatchActive.load(std::memory_order_relaxed);
+    if (kernels == NULL) {
+        // racing threads all pick the same table
+        kernels = dispatchSelect();
+        dispatchActive.store(kernels, std::memory_order_relaxed);
+    }
+    return *kernels;
+}
+#elif defined(VECMATH_SSE)
+// Header-only: only the base kernels exist, and returning them directly lets
+// the compiler inline through the table.
+VECMATH_INLINE const SimdKernels &simdKernels() { return simdKernelsBase(); }
+#endif
+
+VECMATH_INLINE SimdLevel getSimdLevel() {
+#ifdef VECMATH_SSE
+    return simdKernels().level;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+VECMATH_INLINE SimdLevel getMaxSimdLevel() {
+    for (int level = SIMD_AVX512; level > SIMD_SCALAR; --level) {
+        if (isSimdLevelSupported(SimdLevel(level))) {
+            return SimdLevel(level);
+        }
+    }
+    return SIMD_SCALAR;
+}
+
+VECMATH_INLINE bool isSimdLevelSupported(SimdLevel level) {
+#if defined(VECMATH_SSE) && !defined(VECMATH_HEADER_ONLY)
+    return dispatchTable(level) != NULL && dispatchCpuSupports(level);
+#elif defined(VECMATH_SSE)
+    return level == simdKernelsBase().level;
+#else
+    return level == SIMD_SCALAR;
+#endif
+}
+
+VECMATH_INLINE bool setSimdLevel(SimdLevel level) {
+    if (!isSimdLevelSupported(level)) {
+        return false;
+    }
+#if defined(VECMATH_SSE) && !defined(VECMATH_HEADER_ONLY)
+    dispatchActive.store(dispatchTable(level), std::memory_order_relaxed);
+#endif
+    return true;
+}
+
+VECMATH_INLINE const char *getSimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SIMD_SCALAR:
+        return "scalar";
+    case SIMD_SSE2:
+        return "sse2";
+    case SIMD_AVX2:
+        return "avx2";
+    case SIMD_AVX512:
+        return "avx512";
+    }
+    return "unknown";
+}
@@ -0,0 +1,50 @@
+#ifndef SIMD_DISPATCH_H
+#define SIMD_DISPATCH_H
+
+#include "vecmath_config.h"
+
+// Run-time choice of the SIMD kernels behind the batched transforms, the
+// Vec3Array normalizations and the Matrix4f product and inverse.
+//
+// On x86-64 the library compiles those kernels three times: with its own
+// flags (SSE2 unless CXXFLAGS say otherwise), with AVX2 + FMA and with
+// AVX-512F + FMA.  The first call picks the widest set the CPU supports.
+// Setting the environment variable VECMATH_SIMD to a level name ("sse2",
+// "avx2" or "avx512") caps that choice, and setSimdLevel switches level at
+// run time, e.g. to compare the variants.  Levels may differ in the last bit
+// of a result, as AVX2 and AVX-512 fuse multiply-adds.
+//
+// Header-only builds, and libraries compiled with VECMATH_NO_SIMD or for
+// another architecture, have exactly one level: the one they were compiled
+// for.
+enum SimdLevel {
+    SIMD_SCALAR, // no SIMD kernels
+    SIMD_SSE2,
+    SIMD_AVX2,   // AVX2 and FMA
+    SIMD_AVX512, // AVX-512F and FMA
+};
+
+// the level in use
+SimdLevel getSimdLevel();
+
+// the widest level both this CPU and this build support
+SimdLevel getMaxSimdLevel();
+
+// true if level was compiled in and this CPU can run it
+bool isSimdLevelSupported(SimdLevel level);
+
+// Switches to level and returns true if it is supported; otherwise keeps the
+// current level and returns false.  Calls already running in other threads
+// finish at the old level.
+bool setSimdLevel(SimdLevel level);
+
+// "scalar", "sse2", "avx2" or "avx512"
+const char *getSimdLevelName(SimdLevel level);
+
+#ifdef VECMATH_HEADER_ONLY
+// SimdDispatch.cpp needs the kernel table, whose header includes this one, so
+// that header brings in the definitions
+#include "vecmath_kernels.h"
+#endif
+
+#endif // SIMD_DISPATCH_H
@@ -0,0 +1,510 @@
+#include "vecmath_kernels.h"
+
+#ifdef VECMATH_SSE
+// GCC 12's AVX-512 intrinsics start from deliberately uninitialized
+// registers, which it then warns about (GCC bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#include <cstring>
+
+// This file is compiled once per instruction set (see the Makefile), so it
+// includes nothing with inline external-linkage code: the linker keeps one
+// copy of such a function for the whole program, and it could be the AVX-512
+// one.  The kernels live in a namespace named after the table function,
+// VECMATH_KERNELS, so each instruction set's are distinct.  They are inline
+// for header-only builds, which define them in every translation unit.
+#ifndef VECMATH_KERNELS
+#define VECMATH_KERNELS simdKernelsBase
+#endif
+
+namespace vecmath_detail::VECMATH_KERNELS {
+
+// kernelWidth floats at a time.  Everything that moves data between lanes
+// stays within a 128-bit lane, so code written for four floats works
+// unchanged on 8 or 16, as 2 or 4 groups of four side by side.
+#if defined(__AVX512F__)
+typedef __m512 KernelFloat;
+const size_t kernelWidth = 16;
+const SimdLevel kernelLevel = SIMD_AVX512;
+#define KERNEL_FMA
+
+inline KernelFloat kernelLoad(const float *p) { return _mm512_loadu_ps(p); }
+inline void kernelStore(float *p, KernelFloat v) { _mm512_storeu_ps(p, v); }
+inline KernelFloat kernelSet1(float f) { return _mm512_set1_ps(f); }
+inline KernelFloat kernelAdd(KernelFloat a, KernelFloat b) {
+    return _mm512_add_ps(a, b);
+}
+inline KernelFloat kernelSub(KernelFloat a, KernelFloat b) {
+    return _mm512_sub_ps(a, b);
+}
+inline KernelFloat kernelMul(KernelFloat a, KernelFloat b) {
+    return _mm512_mul_ps(a, b);
+}
+inline KernelFloat kernelDiv(KernelFloat a, KernelFloat b) {
+    return _mm512_div_ps(a, b);
+}
+inline KernelFloat kernelMadd(KernelFloat a, KernelFloat b, KernelFloat c) {
+    return _mm512_fmadd_ps(a, b, c);
+}
+inline KernelFloat kernelSqrt(KernelFloat x) { return _mm512_sqrt_ps(x); }
+// relative error 2^-14
+inline KernelFloat kernelRsqrtEstimate(KernelFloat x) {
+    return _mm512_rsqrt14_ps(x);
+}
+
+// lane k holds the four floats at p + k * stride
+inline KernelFloat kernelLoadLanes(const float *p, size_t stride) {
+    __m512 v = _mm512_castps128_ps512(_mm_loadu_ps(p));
+    v = _mm512_insertf32x4(v, _mm_loadu_ps(p + stride), 1);
+    v = _mm512_insertf32x4(v, _mm_loadu_ps(p + 2 * stride), 2);
+    return _mm512_insertf32x4(v, _mm_loadu_ps(p + 3 * stride), 3);
+}
+inline void kernelStoreLanes(float *p, size_t stride, KernelFloat v) {
+    _mm_storeu_ps(p, _mm512_castps512_ps128(v));
+    _mm_storeu_ps(p + stride, _mm512_extractf32x4_ps(v, 1));
+    _mm_storeu_ps(p + 2 * stride, _mm512_extractf32x4_ps(v, 2));
+    _mm_storeu_ps(p + 3 * stride, _mm512_extractf32x4_ps(v, 3));
+}
+// the four floats at p in every lane
+inline KernelFloat kernelBroadcast4(const float *p) {
+    return _mm512_broadcast_f32x4(_mm_loadu_ps(p));
+}
+
+#define KERNEL_SHUFFLE(a, b, imm) _mm512_shuffle_ps(a, b, imm)
+#define KERNEL_PERMUTE(a, imm) _mm512_permute_ps(a, imm)
+#define KERNEL_UNPACKLO(a, b) _mm512_unpacklo_ps(a, b)
+#define KERNEL_UNPACKHI(a, b) _mm512_unpackhi_ps(a, b)
+#elif defined(__AVX__)
+typedef __m256 KernelFloat;
+const size_t kernelWidth = 8;
+#if defined(__AVX2__) && defined(VECMATH_FMA)
+const SimdLevel kernelLevel = SIMD_AVX2;
+#else
+const SimdLevel kernelLevel = SIMD_SSE2;
+#endif
+#ifdef VECMATH_FMA
+#define KERNEL_FMA
+#endif
+
+inline KernelFloat kernelLoad(const float *p) { return _mm256_loadu_ps(p); }
+inline void kernelStore(float *p, KernelFloat v) { _mm256_storeu_ps(p, v); }
+inline KernelFloat kernelSet1(float f) { return _mm256_set1_ps(f); }
+inline KernelFloat kernelAdd(KernelFloat a, KernelFloat b) {
+    return _mm256_add_ps(a, b);
+}
+inline KernelFloat kernelSub(KernelFloat a, KernelFloat b) {
+    return _mm256_sub_ps(a, b);
+}
+inline KernelFloat kernelMul(KernelFloat a, KernelFloat b) {
+    return _mm256_mul_ps(a, b);
+}
+inline KernelFloat kernelDiv(KernelFloat a, KernelFloat b) {
+    return _mm256_div_ps(a, b);
+}
+inline KernelFloat kernelMadd(KernelFloat a, KernelFloat b, KernelFloat c) {
+#ifdef VECMATH_FMA
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+inline KernelFloat kernelSqrt(KernelFloat x) { return _mm256_sqrt_ps(x); }
+// relative error 1.5 * 2^-12
+inline KernelFloat kernelRsqrtEstimate(KernelFloat x) {
+    return _mm256_rsqrt_ps(x);
+}
+
+inline KernelFloat kernelLoadLanes(const float *p, size_t stride) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)),
+                                _mm_loadu_ps(p + stride), 1);
+}
+inline void kernelStoreLanes(float *p, size_t stride, KernelFloat v) {
+    _mm_storeu_ps(p, _mm256_castps256_ps128(v));
+    _mm_storeu_ps(p + stride, _mm256_extractf128_ps(v, 1));
+}
+inline KernelFloat kernelBroadcast4(const float *p) {
+    return _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(p));
+}
+
+#define KERNEL_SHUFFLE(a, b, imm) _mm256_shuffle_ps(a, b, imm)
+#define KERNEL_PERMUTE(a, imm) _mm256_permute_ps(a, imm)
+#define KERNEL_UNPACKLO(a, b) _mm256_unpacklo_ps(a, b)
+#define KERNEL_UNPACKHI(a, b) _mm256_unpackhi_ps(a, b)
+#else
+typedef __m128 KernelFloat;
+const size_t kernelWidth = 4;
+const SimdLevel kernelLevel = SIMD_SSE2;
+#ifdef VECMATH_FMA
+#define KERNEL_FMA
+#endif
+
+inline KernelFloat kernelLoad(const float *p) { return _mm_loadu_ps(p); }
+inline void kernelStore(float *p, KernelFloat v) { _mm_storeu_ps(p, v); }
+inline KernelFloat kernelSet1(float f) { return _mm_set1_ps(f); }
+inline KernelFloat kernelAdd(KernelFloat a, KernelFloat b) {
+    return _mm_add_ps(a, b);
+}
+inline KernelFloat kernelSub(KernelFloat a, KernelFloat b) {
+    return _mm_sub_ps(a, b);
+}
+inline KernelFloat kernelMul(KernelFloat a, KernelFloat b) {
+    return _mm_mul_ps(a, b);
+}
+inline KernelFloat kernelDiv(KernelFloat a, KernelFloat b) {
+    return _mm_div_ps(a, b);
+}
+inline KernelFloat kernelMadd(KernelFloat a, KernelFloat b, KernelFloat c) {
+#ifdef VECMATH_FMA
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+inline KernelFloat kernelSqrt(KernelFloat x) { return _mm_sqrt_ps(x); }
+inline KernelFloat kernelRsqrtEstimate(KernelFloat x) {
+    return _mm_rsqrt_ps(x);
+}
+
+inline KernelFloat kernelLoadLanes(const float *p, size_t) {
+    return _mm_loadu_ps(p);
+}
+inline void kernelStoreLanes(float *p, size_t, KernelFloat v) {
+    _mm_storeu_ps(p, v);
+}
+inline KernelFloat kernelBroadcast4(const float *p) { return _mm_loadu_ps(p); }
+
+#define KERNEL_SHUFFLE(a, b, imm) _mm_shuffle_ps(a, b, imm)
+#define KERNEL_PERMUTE(a, imm) _mm_shuffle_ps(a, a, imm)
+#define KERNEL_UNPACKLO(a, b) _mm_unpacklo_ps(a, b)
+#define KERNEL_UNPACKHI(a, b) _mm_unpackhi_ps(a, b)
+#endif
+
+// 1 / sqrt(x), the estimate refined by one Newton-Raphson step as in
+// simdRsqrt
+inline KernelFloat kernelRsqrt(KernelFloat x) {
+    KernelFloat y = kernelRsqrtEstimate(x);
+    KernelFloat halfXYY =
+        kernelMul(kernelMul(kernelSet1(0.5f), x), kernelMul(y, y));
+    return kernelMul(y, kernelSub(kernelSet1(1.5f), halfXYY));
+}
+
+// Loads kernelWidth packed Vector3f as x, y and z: each lane deinterleaves
+// four of them the way simdLoadVector3fx4 does.
+inline void kernelLoadVector3f(const float *src, KernelFloat &x,
+                               KernelFloat &y, KernelFloat &z) {
+    KernelFloat a = kernelLoadLanes(src, 12);
+    KernelFloat b = kernelLoadLanes(src + 4, 12);
+    KernelFloat c = kernelLoadLanes(src + 8, 12);
+
+    KernelFloat t0 = KERNEL_SHUFFLE(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    KernelFloat t1 = KERNEL_SHUFFLE(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    x = KERNEL_SHUFFLE(a, t0, _MM_SHUFFLE(2, 0, 3, 0));
+    y = KERNEL_SHUFFLE(t1, t0, _MM_SHUFFLE(3, 1, 2, 0));
+    z = KERNEL_SHUFFLE(t1, c, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+// The inverse of kernelLoadVector3f.
+inline void kernelStoreVector3f(float *dst, KernelFloat x, KernelFloat y,
+                                KernelFloat z) {
+    KernelFloat xy0 = KERNEL_UNPACKLO(x, y);
+    KernelFloat xy1 = KERNEL_UNPACKHI(x, y);
+    KernelFloat q = KERNEL_SHUFFLE(z, xy0, _MM_SHUFFLE(2, 2, 0, 0));
+    KernelFloat r = KERNEL_SHUFFLE(xy0, z, _MM_SHUFFLE(1, 1, 3, 3));
+    KernelFloat t = KERNEL_SHUFFLE(z, xy1, _MM_SHUFFLE(3, 2, 3, 2));
+
+    kernelStoreLanes(dst, 12, KERNEL_SHUFFLE(xy0, q, _MM_SHUFFLE(2, 0, 1, 0)));
+    kernelStoreLanes(dst + 4, 12,
+                     KERNEL_SHUFFLE(r, xy1, _MM_SHUFFLE(1, 0, 2, 0)));
+    kernelStoreLanes(dst + 8, 12,
+                     KERNEL_SHUFFLE(t, t, _MM_SHUFFLE(1, 3, 2, 0)));
+}
+
+// Runs block, which maps kernelWidth packed triples, over n of them.  The
+// last n % kernelWidth go through a zero-padded buffer, so they are rounded
+// exactly like the others.
+template <typename Block>
+inline void kernelForEachAoS(const float *in, float *out, size_t n,
+                             Block block) {
+    size_t i = 0;
+    for (; i + kernelWidth <= n; i += kernelWidth) {
+        block(in + 3 * i, out + 3 * i);
+    }
+    if (i < n) {
+        float buffer[3 * kernelWidth] = {};
+        size_t bytes = 3 * (n - i) * sizeof(float);
+        std::memcpy(buffer, in + 3 * i, bytes);
+        block(buffer, buffer);
+        std::memcpy(out + 3 * i, buffer, bytes);
+    }
+}
+
+// The same for separate x, y and z arrays.
+template <typename Block>
+inline void kernelForEachSoA(const float *x, const float *y, const float *z,
+                             float *outX, float *outY, float *outZ, size_t n,
+                             Block block) {
+    size_t i = 0;
+    for (; i + kernelWidth <= n; i += kernelWidth) {
+        block(x + i, y + i, z + i, outX + i, outY + i, outZ + i);
+    }
+    if (i < n) {
+        float buffer[3][kernelWidth] = {};
+        size_t bytes = (n - i) * sizeof(float);
+        std::memcpy(buffer[0], x + i, bytes);
+        std::memcpy(buffer[1], y + i, bytes);
+        std::memcpy(buffer[2], z + i, bytes);
+        block(buffer[0], buffer[1], buffer[2], buffer[0], buffer[1],
+              buffer[2]);
+        std::memcpy(outX + i, buffer[0], bytes);
+        std::memcpy(outY + i, buffer[1], bytes);
+        std::memcpy(outZ + i, buffer[2], bytes);
+    }
+}
+
+struct KernelRows {
+    KernelFloat r[3][4];
+};
+
+inline KernelRows kernelSplat(const float *rows) {
+    KernelRows m;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            m.r[i][j] = kernelSet1(rows[4 * i + j]);
+        }
+    }
+    return m;
+}
+
+inline KernelFloat kernelRow(const KernelRows &m, int i, KernelFloat x,
+                             KernelFloat y, KernelFloat z) {
+#ifdef KERNEL_FMA
+    KernelFloat sum = kernelMadd(m.r[i][0], x, m.r[i][3]);
+    sum = kernelMadd(m.r[i][1], y, sum);
+    return kernelMadd(m.r[i][2], z, sum);
+#else
+    // summed in the same order as Matrix4f * Vector4f
+    KernelFloat sum = kernelAdd(kernelMul(m.r[i][0], x),
+                                kernelMul(m.r[i][1], y));
+    sum = kernelAdd(sum, kernelMul(m.r[i][2], z));
+    return kernelAdd(sum, m.r[i][3]);
+#endif
+}
+
+inline void kernelTransformAoS(const float *rows, const float *in,
+                               float *out, size_t n) {
+    const KernelRows m = kernelSplat(rows);
+    kernelForEachAoS(in, out, n, [&](const float *src, float *dst) {
+        KernelFloat x, y, z;
+        kernelLoadVector3f(src, x, y, z);
+        kernelStoreVector3f(dst, kernelRow(m, 0, x, y, z),
+                            kernelRow(m, 1, x, y, z),
+                            kernelRow(m, 2, x, y, z));
+    });
+}
+
+inline void kernelTransformSoA(const float *rows, const float *x,
+                               const float *y, const float *z, float *outX,
+                               float *outY, float *outZ, size_t n) {
+    const KernelRows m = kernelSplat(rows);
+    kernelForEachSoA(x, y, z, outX, outY, outZ, n,
+                     [&](const float *srcX, const float *srcY,
+                         const float *srcZ, float *dstX, float *dstY,
+                         float *dstZ) {
+                         KernelFloat vx = kernelLoad(srcX);
+                         KernelFloat vy = kernelLoad(srcY);
+                         KernelFloat vz = kernelLoad(srcZ);
+                         kernelStore(dstX, kernelRow(m, 0, vx, vy, vz));
+                         kernelStore(dstY, kernelRow(m, 1, vx, vy, vz));
+                         kernelStore(dstZ, kernelRow(m, 2, vx, vy, vz));
+                     });
+}
+
+template <bool Fast>
+inline void kernelNormalize(KernelFloat &x, KernelFloat &y, KernelFloat &z) {
+    KernelFloat norm2 =
+        kernelAdd(kernelAdd(kernelMul(x, x), kernelMul(y, y)), kernelMul(z, z));
+    if (Fast) {
+        KernelFloat scale = kernelRsqrt(norm2);
+        x = kernelMul(x, scale);
+        y = kernelMul(y, scale);
+        z = kernelMul(z, scale);
+    } else {
+        KernelFloat norm = kernelSqrt(norm2);
+        x = kernelDiv(x, norm);
+        y = kernelDiv(y, norm);
+        z = kernelDiv(z, norm);
+    }
+}
+
+template <bool Fast>
+inline void kernelNormalizeAoS(const float *in, float *out, size_t n) {
+    kernelForEachAoS(in, out, n, [](const float *src, float *dst) {
+        KernelFloat x, y, z;
+        kernelLoadVector3f(src, x, y, z);
+        kernelNormalize<Fast>(x, y, z);
+        kernelStoreVector3f(dst, x, y, z);
+    });
+}
+
+inline void kernelNormalizeAoS(const float *in, float *out, size_t n,
+                               bool fast) {
+    if (fast) {
+        kernelNormalizeAoS<true>(in, out, n);
+    } else {
+        kernelNormalizeAoS<false>(in, out, n);
+    }
+}
+
+template <bool Fast>
+inline void kernelNormalizeSoA(const float *x, const float *y, const float *z,
+                               float *outX, float *outY, float *outZ,
+                               size_t n) {
+    kernelForEachSoA(x, y, z, outX, outY, outZ, n,
+                     [](const float *srcX, const float *srcY,
+                        const float *srcZ, float *dstX, float *dstY,
+                        float *dstZ) {
+                         KernelFloat vx = kernelLoad(srcX);
+                         KernelFloat vy = kernelLoad(srcY);
+                         KernelFloat vz = kernelLoad(srcZ);
+                         kernelNormalize<Fast>(vx, vy, vz);
+                         kernelStore(dstX, vx);
+                         kernelStore(dstY, vy);
+                         kernelStore(dstZ, vz);
+                     });
+}
+
+inline void kernelNormalizeSoA(const float *x, const float *y, const float *z,
+                               float *outX, float *outY, float *outZ,
+                               size_t n, bool fast) {
+    if (fast) {
+        kernelNormalizeSoA<true>(x, y, z, outX, outY, outZ, n);
+    } else {
+        kernelNormalizeSoA<false>(x, y, z, outX, outY, outZ, n);
+    }
+}
+
+inline void kernelMultiply4x4(const float *a, const float *b, float *out) {
+    // column k of the product is sum_j a_j * b(j, k); each lane computes
+    // one column
+    KernelFloat a0 = kernelBroadcast4(a);
+    KernelFloat a1 = kernelBroadcast4(a + 4);
+    KernelFloat a2 = kernelBroadcast4(a + 8);
+    KernelFloat a3 = kernelBroadcast4(a + 12);
+
+    for (size_t k = 0; k < 16; k += kernelWidth) {
+        KernelFloat bk = kernelLoad(b + k);
+        KernelFloat sum = kernelMul(a0, KERNEL_PERMUTE(bk, 0x00));
+        sum = kernelMadd(a1, KERNEL_PERMUTE(bk, 0x55), sum);
+        sum = kernelMadd(a2, KERNEL_PERMUTE(bk, 0xAA), sum);
+        sum = kernelMadd(a3, KERNEL_PERMUTE(bk, 0xFF), sum);
+        kernelStore(out + k, sum);
+    }
+}
+
+inline float kernelInverse4x4(const float *m, float *out) {
+    // Cramer's rule on 2x2 sub-determinants, after Intel AP-928.  The
+    // algorithm works on the transpose, so feeding it the column-major
+    // storage directly yields the column-major inverse.  A single matrix
+    // fits in four __m128, so this is the same at every level.
+    __m128 row0 = _mm_loadu_ps(m);
+    __m128 row1 = _mm_loadu_ps(m + 4);
+    __m128 row2 = _mm_loadu_ps(m + 8);
+    __m128 row3 = _mm_loadu_ps(m + 12);
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+    row1 = _mm_shuffle_ps(row1, row1, 0x4E);
+    row3 = _mm_shuffle_ps(row3, row3, 0x4E);
+
+    __m128 minor0, minor1, minor2, minor3, tmp;
+
+    tmp = _mm_mul_ps(row2, row3);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor0 = _mm_mul_ps(row1, tmp);
+    minor1 = _mm_mul_ps(row0, tmp);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp), minor0);
+    minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor1);
+    minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+    tmp = _mm_mul_ps(row1, row2);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor0);
+    minor3 = _mm_mul_ps(row0, tmp);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp));
+    minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor3);
+    minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+    tmp = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    row2 = _mm_shuffle_ps(row2, row2, 0x4E);
+    minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor0);
+    minor2 = _mm_mul_ps(row0, tmp);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp));
+    minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor2);
+    minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+    tmp = _mm_mul_ps(row0, row1);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor2);
+    minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp), minor3);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp), minor2);
+    minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp));
+
+    tmp = _mm_mul_ps(row0, row3);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp));
+    minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor2);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor1);
+    minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp));
+
+    tmp = _mm_mul_ps(row0, row2);
+    tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor1);
+    minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp));
+    tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp));
+    minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor3);
+
+    __m128 det = _mm_mul_ps(row0, minor0);
+    det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+    det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+    float determinant = _mm_cvtss_f32(det);
+
+    __m128 reciprocalDeterminant = _mm_set1_ps(1.0f / determinant);
+    _mm_storeu_ps(out, _mm_mul_ps(minor0, reciprocalDeterminant));
+    _mm_storeu_ps(out + 4, _mm_mul_ps(minor1, reciprocalDeterminant));
+    _mm_storeu_ps(out + 8, _mm_mul_ps(minor2, reciprocalDeterminant));
+    _mm_storeu_ps(out + 12, _mm_mul_ps(minor3, reciprocalDeterminant));
+    return determinant;
+}
+
+} // namespace vecmath_detail::VECMATH_KERNELS
+
+VECMATH_INLINE const SimdKernels &VECMATH_KERNELS() {
+    using namespace vecmath_detail::VECMATH_KERNELS;
+    static constexpr SimdKernels kernels = {
+        kernelLevel,        kernelTransformAoS, kernelTransformSoA,
+        kernelNormalizeAoS, kernelNormalizeSoA, kernelMultiply4x4,
+        kernelInverse4x4,
+    };
+    return kernels;
+}
+
+#undef KERNEL_FMA
+#undef KERNEL_SHUFFLE
+#undef KERNEL_PERMUTE
+#undef KERNEL_UNPACKLO
+#undef KERNEL_UNPACKHI
+#undef VECMATH_KERNELS
+#endif // VECMATH_SSE
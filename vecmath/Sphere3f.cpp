@@ -0,0 +1,136 @@
+#include "Sphere3f.h"
+
+#include "Box3f.h"
+#include "Matrix4f.h"
+#include "vecmath_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+VECMATH_INLINE bool Sphere3f::contains(const Vector3f &p) const {
+    return !isEmpty() && (p - m_center).absSquared() <= m_radius * m_radius;
+}
+
+VECMATH_INLINE bool Sphere3f::overlaps(const Sphere3f &s) const {
+    float r = m_radius + s.m_radius;
+    return !isEmpty() && !s.isEmpty() &&
+           (s.m_center - m_center).absSquared() <= r * r;
+}
+
+VECMATH_INLINE bool Sphere3f::overlaps(const Box3f &b) const {
+    if (isEmpty() || b.isEmpty()) {
+        return false;
+    }
+
+    // squared distance from the center to the closest point of b
+    float d2 = 0.f;
+    for (int i = 0; i < 3; ++i) {
+        float c = m_center[i];
+        float d = std::max(b.getMin()[i] - c, 0.f) +
+                  std::max(c - b.getMax()[i], 0.f);
+        d2 += d * d;
+    }
+    return d2 <= m_radius * m_radius;
+}
+
+VECMATH_INLINE Sphere3f Sphere3f::transformed(const Matrix4f &m) const {
+    if (isEmpty()) {
+        return *this;
+    }
+
+    float scale2 = 0.f;
+    for (int j = 0; j < 3; ++j) {
+        scale2 = std::max(scale2, m(0, j) * m(0, j) + m(1, j) * m(1, j) +
+                                      m(2, j) * m(2, j));
+    }
+    return Sphere3f(m.transformPoint(m_center),
+                    m_radius * std::sqrt(scale2));
+}
+
+VECMATH_INLINE bool Sphere3f::intersectRay(const Vector3f &origin,
+                                           const Vector3f &direction,
+                                           float *tNear, float *tFar) const {
+    if (isEmpty()) {
+        return false;
+    }
+
+    // |origin + t * direction - center|^2 = radius^2, i.e.
+    // a t^2 + 2 b t + c = 0
+    Vector3f oc = origin - m_center;
+    float a = Vector3f::dot(direction, direction);
+    float b = Vector3f::dot(direction, oc);
+    float c = oc.absSquared() - m_radius * m_radius;
+
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.f) {
+        return false;
+    }
+    float root = std::sqrt(discriminant);
+    float t1 = (-b + root) / a;
+    if (t1 < 0.f) {
+        return false;
+    }
+    if (tNear != NULL) {
+        *tNear = std::max((-b - root) / a, 0.f);
+    }
+    if (tFar != NULL) {
+        *tFar = t1;
+    }
+    return true;
+}
+
+VECMATH_INLINE void Sphere3f::print() const {
+    printf("[ %.4f %.4f %.4f ] r %.4f\n", m_center[0], m_center[1],
+           m_center[2], m_radius);
+}
+
+// static
+VECMATH_INLINE Sphere3f Sphere3f::fromPoints(const Vector3f *points,
+                                             size_t n) {
+    Box3f box = Box3f::fromPoints(points, n);
+    if (box.isEmpty()) {
+        return Sphere3f();
+    }
+
+    Vector3f c = box.center();
+    float r2 = 0.f;
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    __m128 cx = _mm_set1_ps(c[0]);
+    __m128 cy = _mm_set1_ps(c[1]);
+    __m128 cz = _mm_set1_ps(c[2]);
+    __m128 maxR2 = _mm_setzero_ps();
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        simdLoadVector3fx4(&points[i][0], x, y, z);
+        x = _mm_sub_ps(x, cx);
+        y = _mm_sub_ps(y, cy);
+        z = _mm_sub_ps(z, cz);
+        __m128 d2 = _mm_mul_ps(x, x);
+        d2 = simdMadd(y, y, d2);
+        d2 = simdMadd(z, z, d2);
+        maxR2 = _mm_max_ps(d2, maxR2);
+    }
+    r2 = simdHMax(maxR2);
+#endif
+
+    for (; i < n; ++i) {
+        r2 = std::max((points[i] - c).absSquared(), r2);
+    }
+
+    // pad by a few ulp so every point passes contains() despite rounding
+    return Sphere3f(c, std::sqrt(r2) * (1.f + 1e-6f));
+}
+
+// static
+VECMATH_INLINE Sphere3f Sphere3f::fromBox(const Box3f &b) {
+    if (b.isEmpty()) {
+        return Sphere3f();
+    }
+    return Sphere3f(b.center(), b.halfExtent().abs());
+}
@@ -0,0 +1,73 @@
+#ifndef SPHERE3F_H
+#define SPHERE3F_H
+
+#include "vecmath_config.h"
+
+#include "Vector3f.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <type_traits>
+
+class Box3f;
+class Matrix4f;
+
+// Bounding sphere.  A negative radius marks the empty sphere, the default.
+class Sphere3f {
+  public:
+    // empty
+    constexpr Sphere3f() : m_center(0), m_radius(-1) {}
+    constexpr Sphere3f(const Vector3f &center, float radius)
+        : m_center(center), m_radius(radius) {}
+
+    // implicit copy constructor and assignment operator (trivially copyable)
+    // no destructor necessary
+
+    constexpr const Vector3f &getCenter() const { return m_center; }
+    constexpr float getRadius() const { return m_radius; }
+
+    constexpr bool isEmpty() const { return !(m_radius >= 0); }
+
+    // inclusive of the surface
+    bool contains(const Vector3f &p) const;
+    bool overlaps(const Sphere3f &s) const;
+    bool overlaps(const Box3f &b) const;
+
+    // Bounds of this sphere transformed by m, which is assumed to be affine:
+    // the radius scales by the longest column of m's upper 3x3.
+    Sphere3f transformed(const Matrix4f &m) const;
+
+    // The ray origin + t * direction, t >= 0, as Box3f::intersectRay.
+    // direction must not be zero.
+    bool intersectRay(const Vector3f &origin, const Vector3f &direction,
+                      float *tNear = NULL, float *tFar = NULL) const;
+
+    // ---- Utility ----
+    void print() const;
+
+    // A sphere containing n points: centered on their bounding box, with the
+    // radius from a second SIMD pass over the points.  Not the smallest such
+    // sphere, but within a factor of sqrt(3) of it.
+    static Sphere3f fromPoints(const Vector3f *points, size_t n);
+
+    // the sphere through the corners of b
+    static Sphere3f fromBox(const Box3f &b);
+
+  private:
+    Vector3f m_center;
+    float m_radius;
+};
+
+static_assert(std::is_trivially_copyable<Sphere3f>::value,
+              "Sphere3f must be trivially copyable");
+static_assert(std::is_standard_layout<Sphere3f>::value &&
+                  sizeof(Sphere3f) == 4 * sizeof(float),
+              "Sphere3f must be laid out as 4 packed floats");
+static_assert(Sphere3f().isEmpty() && !Sphere3f(Vector3f(0), 0).isEmpty(),
+              "Sphere3f must be usable in constant expressions");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Sphere3f.cpp"
+#endif
+
+#endif // SPHERE3F_H
@@ -0,0 +1,82 @@
+#include "TransformHierarchy.h"
+
+#include "Matrix4f.h"
+
+#include <algorithm>
+#include <cassert>
+
+VECMATH_INLINE void TransformHierarchy::reserve(size_t n) {
+    m_local.reserve(n);
+    m_world.reserve(n);
+    m_parent.reserve(n);
+    m_dirty.reserve(n);
+}
+
+VECMATH_INLINE size_t TransformHierarchy::addNode(const Affine3f &local,
+                                                  size_t parent) {
+    assert(parent == NO_PARENT || parent < size());
+
+    size_t node = size();
+    m_local.push_back(local);
+    m_world.push_back(local);
+    m_parent.push_back(parent);
+    m_dirty.push_back(1);
+    m_firstDirty = std::min(m_firstDirty, node);
+    return node;
+}
+
+VECMATH_INLINE void TransformHierarchy::setLocal(size_t node,
+                                                 const Affine3f &local) {
+    assert(node < size());
+
+    m_local[node] = local;
+    m_dirty[node] = 1;
+    m_firstDirty = std::min(m_firstDirty, node);
+}
+
+VECMATH_INLINE size_t TransformHierarchy::update() {
+    size_t n = size();
+    size_t recomputed = 0;
+
+    // parents precede children, so one pass sees every parent's final state;
+    // nodes before m_firstDirty are all clean
+    for (size_t i = m_firstDirty; i < n; ++i) {
+        size_t parent = m_parent[i];
+        bool rootOrClean = parent == NO_PARENT || parent < m_firstDirty;
+        if (!rootOrClean && m_dirty[parent]) {
+            m_dirty[i] = 1;
+        }
+        if (m_dirty[i]) {
+            m_world[i] = parent == NO_PARENT ? m_local[i]
+                                             : m_world[parent] * m_local[i];
+            ++recomputed;
+        }
+    }
+
+    std::fill(m_dirty.begin() + m_firstDirty, m_dirty.end(), 0);
+    m_firstDirty = n;
+    return recomputed;
+}
+
+VECMATH_INLINE const Affine3f &TransformHierarchy::getWorld(size_t node) {
+    assert(node < size());
+
+    if (isDirty()) {
+        update();
+    }
+    return m_world[node];
+}
+
+VECMATH_INLINE const Affine3f *TransformHierarchy::getWorldTransforms() {
+    if (isDirty()) {
+        update();
+    }
+    return m_world.data();
+}
+
+VECMATH_INLINE void TransformHierarchy::getWorldMatrices(Matrix4f *out) {
+    const Affine3f *world = getWorldTransforms();
+    for (size_t i = 0; i < size(); ++i) {
+        out[i] = world[i].toMatrix4f();
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+#include "vecmath_config.h"
+
+#include "Affine3f.h"
+
+#include <cstddef>
+#include <vector>
+
+class Matrix4f;
+
+// A forest of transform nodes, the CPU-side counterpart of a glPushMatrix /
+// glMultMatrixf stack.  Each node has a local transform relative to its
+// parent, and its world transform is the parent's world transform times the
+// local one.
+//
+// Nodes live in flat arrays in the order they were added, and a parent is
+// always added before its children.  Changing a local transform only marks
+// the node dirty; the world transforms are recomputed lazily, in one forward
+// pass that starts at the first dirty node and touches only the dirty nodes
+// and their descendants.  The world transforms are then contiguous, ready for
+// a batch upload or software transform.
+class TransformHierarchy {
+  public:
+    static constexpr size_t NO_PARENT = static_cast<size_t>(-1);
+
+    TransformHierarchy() : m_firstDirty(0) {}
+
+    void reserve(size_t n);
+
+    // Appends a node and returns its index.  parent is an existing node, or
+    // NO_PARENT for a root.
+    size_t addNode(const Affine3f &local, size_t parent = NO_PARENT);
+
+    size_t size() const { return m_local.size(); }
+    size_t getParent(size_t node) const { return m_parent[node]; }
+
+    const Affine3f &getLocal(size_t node) const { return m_local[node]; }
+    // marks node, and so its whole subtree, for recomputation
+    void setLocal(size_t node, const Affine3f &local);
+
+    bool isDirty() const { return m_firstDirty < size(); }
+
+    // Recomputes the world transforms of dirty nodes and their descendants.
+    // Returns how many were recomputed.
+    size_t update();
+
+    // These update first if anything is dirty.
+    const Affine3f &getWorld(size_t node);
+    // all size() world transforms, in node order
+    const Affine3f *getWorldTransforms();
+    // the same as column-major 4x4 matrices (e.g. for glLoadMatrixf); out has
+    // room for size() of them
+    void getWorldMatrices(Matrix4f *out);
+
+  private:
+    std::vector<Affine3f> m_local;
+    std::vector<Affine3f> m_world;
+    std::vector<size_t> m_parent;
+    // one byte per node; std::vector<bool> would pack bits
+    std::vector<unsigned char> m_dirty;
+    // size() when nothing is dirty
+    size_t m_firstDirty;
+};
+
+#ifdef VECMATH_HEADER_ONLY
+#include "TransformHierarchy.cpp"
+#endif
+
+#endif // TRANSFORM_HIERARCHY_H
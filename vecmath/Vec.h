@@ -0,0 +1,140 @@
+#ifndef VEC_H
+#define VEC_H
+
+#include "vecmath_config.h"
+
+#include "Vector3f.h"
+
+#include <cmath>
+#include <type_traits>
+
+// N-component vector of T, for the few computations that float rounding
+// spoils: Vec3d carries a1's curve frames and a0's simplification quadrics
+// in double.  It converts to and from Vector3f with toVec and toVector3f;
+// everything else uses the float classes.
+template <typename T, int N> class Vec {
+    static_assert(N >= 1, "Vec needs at least one component");
+
+  public:
+    static constexpr int size = N;
+
+    constexpr Vec() : m_elements{} {}
+    constexpr explicit Vec(T fill) : m_elements{} {
+        for (int i = 0; i < N; ++i) {
+            m_elements[i] = fill;
+        }
+    }
+
+    // one value per component, e.g. Vec3d(x, y, z)
+    template <typename... Ts, typename = std::enable_if_t<
+                                  N >= 2 && sizeof...(Ts) == N>>
+    constexpr Vec(Ts... xs) : m_elements{static_cast<T>(xs)...} {}
+
+    // implicit copy constructor and assignment operator (trivially copyable
+    // for trivially copyable T)
+    // no destructor necessary
+
+    constexpr const T &operator[](int i) const { return m_elements[i]; }
+    constexpr T &operator[](int i) { return m_elements[i]; }
+
+    constexpr T absSquared() const { return dot(*this, *this); }
+    T abs() const { return std::sqrt(absSquared()); }
+
+    void normalize() { *this /= abs(); }
+    Vec normalized() const { return *this / abs(); }
+
+    constexpr Vec &operator+=(const Vec &v) {
+        for (int i = 0; i < N; ++i) {
+            m_elements[i] += v[i];
+        }
+        return *this;
+    }
+    constexpr Vec &operator-=(const Vec &v) {
+        for (int i = 0; i < N; ++i) {
+            m_elements[i] -= v[i];
+        }
+        return *this;
+    }
+    constexpr Vec &operator*=(T f) {
+        for (int i = 0; i < N; ++i) {
+            m_elements[i] *= f;
+        }
+        return *this;
+    }
+    constexpr Vec &operator/=(T f) {
+        for (int i = 0; i < N; ++i) {
+            m_elements[i] /= f;
+        }
+        return *this;
+    }
+
+    static constexpr T dot(const Vec &v0, const Vec &v1) {
+        T sum = v0[0] * v1[0];
+        for (int i = 1; i < N; ++i) {
+            sum += v0[i] * v1[i];
+        }
+        return sum;
+    }
+
+    static constexpr Vec cross(const Vec &v0, const Vec &v1) {
+        static_assert(N == 3, "cross is only defined for 3 components");
+        return Vec(v0[1] * v1[2] - v0[2] * v1[1], v0[2] * v1[0] - v0[0] * v1[2],
+                   v0[0] * v1[1] - v0[1] * v1[0]);
+    }
+
+
+  private:
+    T m_elements[N];
+};
+
+template <typename T, int N>
+constexpr Vec<T, N> operator+(Vec<T, N> v0, const Vec<T, N> &v1) {
+    return v0 += v1;
+}
+
+template <typename T, int N>
+constexpr Vec<T, N> operator-(Vec<T, N> v0, const Vec<T, N> &v1) {
+    return v0 -= v1;
+}
+
+template <typename T, int N> constexpr Vec<T, N> operator-(Vec<T, N> v) {
+    for (int i = 0; i < N; ++i) {
+        v[i] = -v[i];
+    }
+    return v;
+}
+
+template <typename T, int N>
+constexpr Vec<T, N> operator*(T f, Vec<T, N> v) {
+    return v *= f;
+}
+
+template <typename T, int N>
+constexpr Vec<T, N> operator*(Vec<T, N> v, T f) {
+    return v *= f;
+}
+
+template <typename T, int N>
+constexpr Vec<T, N> operator/(Vec<T, N> v, T f) {
+    return v /= f;
+}
+
+using Vec3d = Vec<double, 3>;
+
+// Conversions to and from Vector3f, e.g. toVec<double>(v)
+template <typename T> Vec<T, 3> toVec(const Vector3f &v) {
+    return Vec<T, 3>(v[0], v[1], v[2]);
+}
+
+template <typename T> Vector3f toVector3f(const Vec<T, 3> &v) {
+    return Vector3f(static_cast<float>(v[0]), static_cast<float>(v[1]),
+                    static_cast<float>(v[2]));
+}
+
+static_assert(std::is_trivially_copyable<Vec3d>::value &&
+                  sizeof(Vec3d) == 3 * sizeof(double),
+              "Vec3d must be laid out as 3 packed doubles");
+static_assert(Vec3d::dot(Vec3d(1, 2, 3), Vec3d(4, 5, 6)) == 32,
+              "Vec must be usable in constant expressions");
+
+#endif // VEC_H
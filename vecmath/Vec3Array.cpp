@@ -0,0 +1,430 @@
+#include "Vec3Array.h"
+
+#include "Vector3f.h"
+#include "vecmath_kernels.h"
+#include "vecmath_simd.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace vecmath_detail {
+
+// lanes are padded to whole SIMD registers so every lane stays aligned
+constexpr size_t kVec3LaneGranule = Vec3Array::kAlignment / sizeof(float);
+
+inline size_t vec3RoundCapacity(size_t n) {
+    return (n + kVec3LaneGranule - 1) / kVec3LaneGranule * kVec3LaneGranule;
+}
+
+inline float *vec3Allocate(size_t capacity) {
+    if (capacity == 0) {
+        return nullptr;
+    }
+    return static_cast<float *>(
+        ::operator new(3 * capacity * sizeof(float),
+                       std::align_val_t(Vec3Array::kAlignment)));
+}
+
+inline void vec3Free(float *data) {
+    ::operator delete(data, std::align_val_t(Vec3Array::kAlignment));
+}
+
+#ifdef VECMATH_SSE
+// true if v is a view of a Vector3f buffer, which loads with shuffles
+inline bool vec3IsPacked(const Vec3View &v) {
+    return v.stride() == 3 && v.y() == v.x() + 1 && v.z() == v.x() + 2;
+}
+
+inline __m128 vec3Gather(const float *p, size_t stride) {
+    return _mm_setr_ps(p[0], p[stride], p[2 * stride], p[3 * stride]);
+}
+
+inline void vec3Scatter(float *p, size_t stride, __m128 v) {
+    alignas(16) float f[4];
+    _mm_store_ps(f, v);
+    for (int k = 0; k < 4; ++k) {
+        p[k * stride] = f[k];
+    }
+}
+
+// loads elements i..i+3 of v
+inline void vec3Load(const Vec3View &v, size_t i, __m128 &x, __m128 &y,
+                     __m128 &z) {
+    if (v.stride() == 1) {
+        x = _mm_loadu_ps(v.x() + i);
+        y = _mm_loadu_ps(v.y() + i);
+        z = _mm_loadu_ps(v.z() + i);
+    } else if (vec3IsPacked(v)) {
+        simdLoadVector3fx4(v.x() + 3 * i, x, y, z);
+    } else {
+        size_t offset = i * v.stride();
+        x = vec3Gather(v.x() + offset, v.stride());
+        y = vec3Gather(v.y() + offset, v.stride());
+        z = vec3Gather(v.z() + offset, v.stride());
+    }
+}
+
+// stores elements i..i+3 of v
+inline void vec3Store(const Vec3View &v, size_t i, __m128 x, __m128 y,
+                      __m128 z) {
+    if (v.stride() == 1) {
+        _mm_storeu_ps(v.x() + i, x);
+        _mm_storeu_ps(v.y() + i, y);
+        _mm_storeu_ps(v.z() + i, z);
+    } else if (vec3IsPacked(v)) {
+        simdStoreVector3fx4(v.x() + 3 * i, x, y, z);
+    } else {
+        size_t offset = i * v.stride();
+        vec3Scatter(v.x() + offset, v.stride(), x);
+        vec3Scatter(v.y() + offset, v.stride(), y);
+        vec3Scatter(v.z() + offset, v.stride(), z);
+    }
+}
+
+inline __m128 vec3Dot(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by,
+                      __m128 bz) {
+    __m128 sum = _mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by));
+    return _mm_add_ps(sum, _mm_mul_ps(az, bz));
+}
+
+// Normalizes with the dispatched kernels when a and out are both stride 1 or
+// both Vector3f buffers; returns false, doing nothing, for other layouts.
+inline bool vec3NormalizeKernel(const Vec3View &a, const Vec3View &out,
+                                bool fast) {
+    const SimdKernels &kernels = simdKernels();
+    if (a.stride() == 1 && out.stride() == 1) {
+        kernels.normalizeSoA(a.x(), a.y(), a.z(), out.x(), out.y(), out.z(),
+                             a.size(), fast);
+        return true;
+    }
+    if (vec3IsPacked(a) && vec3IsPacked(out)) {
+        kernels.normalizeAoS(a.x(), out.x(), a.size(), fast);
+        return true;
+    }
+    return false;
+}
+#endif
+
+} // namespace vecmath_detail
+
+VECMATH_INLINE Vec3View::Vec3View(Vector3f *data, size_t size)
+    : Vec3View(reinterpret_cast<float *>(data),
+               reinterpret_cast<float *>(data) + 1,
+               reinterpret_cast<float *>(data) + 2, size, 3) {}
+
+// Inputs are never written through a view, so a const buffer can be viewed.
+VECMATH_INLINE Vec3View::Vec3View(const Vector3f *data, size_t size)
+    : Vec3View(const_cast<Vector3f *>(data), size) {}
+
+VECMATH_INLINE Vec3View::Vec3View(Vec3Array &a)
+    : Vec3View(a.x(), a.y(), a.z(), a.size()) {}
+
+VECMATH_INLINE Vec3View::Vec3View(const Vec3Array &a)
+    : Vec3View(const_cast<Vec3Array &>(a)) {}
+
+VECMATH_INLINE Vector3f Vec3View::get(size_t i) const {
+    size_t offset = i * m_stride;
+    return Vector3f(m_x[offset], m_y[offset], m_z[offset]);
+}
+
+VECMATH_INLINE void Vec3View::set(size_t i, const Vector3f &v) const {
+    size_t offset = i * m_stride;
+    m_x[offset] = v[0];
+    m_y[offset] = v[1];
+    m_z[offset] = v[2];
+}
+
+VECMATH_INLINE Vec3Array::Vec3Array()
+    : m_data(nullptr), m_size(0), m_capacity(0) {}
+
+VECMATH_INLINE Vec3Array::Vec3Array(size_t size) : Vec3Array() {
+    resize(size);
+}
+
+VECMATH_INLINE Vec3Array::Vec3Array(const Vec3View &v) : Vec3Array() {
+    reserve(v.size());
+    m_size = v.size();
+
+    const Vec3View out(*this);
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= m_size; i += 4) {
+        __m128 x, y, z;
+        vecmath_detail::vec3Load(v, i, x, y, z);
+        vecmath_detail::vec3Store(out, i, x, y, z);
+    }
+#endif
+
+    for (; i < m_size; ++i) {
+        out.set(i, v.get(i));
+    }
+}
+
+VECMATH_INLINE Vec3Array::Vec3Array(const Vec3Array &a) : Vec3Array() {
+    *this = a;
+}
+
+VECMATH_INLINE Vec3Array::Vec3Array(Vec3Array &&a) noexcept
+    : m_data(a.m_data), m_size(a.m_size), m_capacity(a.m_capacity) {
+    a.m_data = nullptr;
+    a.m_size = 0;
+    a.m_capacity = 0;
+}
+
+VECMATH_INLINE Vec3Array &Vec3Array::operator=(const Vec3Array &a) {
+    if (this != &a) {
+        m_size = 0;
+        reserve(a.m_size);
+        m_size = a.m_size;
+        if (m_size > 0) {
+            memcpy(x(), a.x(), m_size * sizeof(float));
+            memcpy(y(), a.y(), m_size * sizeof(float));
+            memcpy(z(), a.z(), m_size * sizeof(float));
+        }
+    }
+    return *this;
+}
+
+VECMATH_INLINE Vec3Array &Vec3Array::operator=(Vec3Array &&a) noexcept {
+    std::swap(m_data, a.m_data);
+    std::swap(m_size, a.m_size);
+    std::swap(m_capacity, a.m_capacity);
+    return *this;
+}
+
+VECMATH_INLINE Vec3Array::~Vec3Array() { vecmath_detail::vec3Free(m_data); }
+
+VECMATH_INLINE void Vec3Array::resize(size_t size) {
+    reserve(size);
+    if (size > m_size) {
+        size_t added = (size - m_size) * sizeof(float);
+        memset(x() + m_size, 0, added);
+        memset(y() + m_size, 0, added);
+        memset(z() + m_size, 0, added);
+    }
+    m_size = size;
+}
+
+VECMATH_INLINE void Vec3Array::reserve(size_t capacity) {
+    if (capacity <= m_capacity) {
+        return;
+    }
+
+    size_t newCapacity = vecmath_detail::vec3RoundCapacity(capacity);
+    float *data = vecmath_detail::vec3Allocate(newCapacity);
+    if (m_size > 0) {
+        memcpy(data, x(), m_size * sizeof(float));
+        memcpy(data + newCapacity, y(), m_size * sizeof(float));
+        memcpy(data + 2 * newCapacity, z(), m_size * sizeof(float));
+    }
+    vecmath_detail::vec3Free(m_data);
+
+    m_data = data;
+    m_capacity = newCapacity;
+}
+
+VECMATH_INLINE void Vec3Array::push_back(const Vector3f &v) {
+    if (m_size == m_capacity) {
+        reserve(m_capacity == 0 ? vecmath_detail::kVec3LaneGranule
+                                : 2 * m_capacity);
+    }
+    set(m_size++, v);
+}
+
+VECMATH_INLINE Vector3f Vec3Array::get(size_t i) const {
+    return Vector3f(x()[i], y()[i], z()[i]);
+}
+
+VECMATH_INLINE void Vec3Array::set(size_t i, const Vector3f &v) {
+    x()[i] = v[0];
+    y()[i] = v[1];
+    z()[i] = v[2];
+}
+
+VECMATH_INLINE void Vec3Array::copyTo(Vector3f *out) const {
+    const Vec3View in(*this);
+    const Vec3View dst(out, m_size);
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= m_size; i += 4) {
+        __m128 x, y, z;
+        vecmath_detail::vec3Load(in, i, x, y, z);
+        vecmath_detail::vec3Store(dst, i, x, y, z);
+    }
+#endif
+
+    for (; i < m_size; ++i) {
+        dst.set(i, in.get(i));
+    }
+}
+
+VECMATH_INLINE void add(const Vec3View &a, const Vec3View &b,
+                        const Vec3View &out) {
+    assert(a.size() == b.size() && a.size() == out.size());
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= a.size(); i += 4) {
+        __m128 ax, ay, az, bx, by, bz;
+        vecmath_detail::vec3Load(a, i, ax, ay, az);
+        vecmath_detail::vec3Load(b, i, bx, by, bz);
+        vecmath_detail::vec3Store(out, i, _mm_add_ps(ax, bx),
+                                  _mm_add_ps(ay, by), _mm_add_ps(az, bz));
+    }
+#endif
+
+    for (; i < a.size(); ++i) {
+        out.set(i, a.get(i) + b.get(i));
+    }
+}
+
+VECMATH_INLINE void scale(const Vec3View &a, float s, const Vec3View &out) {
+    assert(a.size() == out.size());
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    const __m128 vs = _mm_set1_ps(s);
+    for (; i + 4 <= a.size(); i += 4) {
+        __m128 x, y, z;
+        vecmath_detail::vec3Load(a, i, x, y, z);
+        vecmath_detail::vec3Store(out, i, _mm_mul_ps(vs, x), _mm_mul_ps(vs, y),
+                                  _mm_mul_ps(vs, z));
+    }
+#endif
+
+    for (; i < a.size(); ++i) {
+        out.set(i, s * a.get(i));
+    }
+}
+
+VECMATH_INLINE void madd(const Vec3View &a, float s, const Vec3View &b,
+                         const Vec3View &out) {
+    assert(a.size() == b.size() && a.size() == out.size());
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    const __m128 vs = _mm_set1_ps(s);
+    for (; i + 4 <= a.size(); i += 4) {
+        __m128 ax, ay, az, bx, by, bz;
+        vecmath_detail::vec3Load(a, i, ax, ay, az);
+        vecmath_detail::vec3Load(b, i, bx, by, bz);
+        vecmath_detail::vec3Store(out, i, simdMadd(ax, vs, bx),
+                                  simdMadd(ay, vs, by), simdMadd(az, vs, bz));
+    }
+#endif
+
+    for (; i < a.size(); ++i) {
+        out.set(i, Vector3f::madd(a.get(i), s, b.get(i)));
+    }
+}
+
+VECMATH_INLINE void dot(const Vec3View &a, const Vec3View &b, float *out) {
+    assert(a.size() == b.size());
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= a.size(); i += 4) {
+        __m128 ax, ay, az, bx, by, bz;
+        vecmath_detail::vec3Load(a, i, ax, ay, az);
+        vecmath_detail::vec3Load(b, i, bx, by, bz);
+        _mm_storeu_ps(out + i, vecmath_detail::vec3Dot(ax, ay, az, bx, by, bz));
+    }
+#endif
+
+    for (; i < a.size(); ++i) {
+        out[i] = Vector3f::dot(a.get(i), b.get(i));
+    }
+}
+
+VECMATH_INLINE void cross(const Vec3View &a, const Vec3View &b,
+                          const Vec3View &out) {
+    assert(a.size() == b.size() && a.size() == out.size());
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    for (; i + 4 <= a.size(); i += 4) {
+        __m128 ax, ay, az, bx, by, bz;
+        vecmath_detail::vec3Load(a, i, ax, ay, az);
+        vecmath_detail::vec3Load(b, i, bx, by, bz);
+        vecmath_detail::vec3Store(
+            out, i, _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)),
+            _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz)),
+            _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx)));
+    }
+#endif
+
+    for (; i < a.size(); ++i) {
+        out.set(i, Vector3f::cross(a.get(i), b.get(i)));
+    }
+}
+
+VECMATH_INLINE void normalize(const Vec3View &a, const Vec3View &out) {
+    assert(a.size() == out.size());
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    if (vecmath_detail::vec3NormalizeKernel(a, out, false)) {
+        return;
+    }
+    for (; i + 4 <= a.size(); i += 4) {
+        __m128 x, y, z;
+        vecmath_detail::vec3Load(a, i, x, y, z);
+        __m128 norm = _mm_sqrt_ps(vecmath_detail::vec3Dot(x, y, z, x, y, z));
+        vecmath_detail::vec3Store(out, i, _mm_div_ps(x, norm),
+                                  _mm_div_ps(y, norm), _mm_div_ps(z, norm));
+    }
+#endif
+
+    for (; i < a.size(); ++i) {
+        out.set(i, a.get(i).normalized());
+    }
+}
+
+VECMATH_INLINE void normalizeFast(const Vec3View &a, const Vec3View &out) {
+    assert(a.size() == out.size());
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    if (vecmath_detail::vec3NormalizeKernel(a, out, true)) {
+        return;
+    }
+    for (; i + 4 <= a.size(); i += 4) {
+        __m128 x, y, z;
+        vecmath_detail::vec3Load(a, i, x, y, z);
+        __m128 scale = simdRsqrt(vecmath_detail::vec3Dot(x, y, z, x, y, z));
+        vecmath_detail::vec3Store(out, i, _mm_mul_ps(x, scale),
+                                  _mm_mul_ps(y, scale), _mm_mul_ps(z, scale));
+    }
+#endif
+
+    for (; i < a.size(); ++i) {
+        out.set(i, a.get(i).normalizedFast());
+    }
+}
+
+VECMATH_INLINE void lerp(const Vec3View &a, const Vec3View &b, float t,
+                         const Vec3View &out) {
+    assert(a.size() == b.size() && a.size() == out.size());
+    size_t i = 0;
+
+#ifdef VECMATH_SSE
+    const __m128 vt = _mm_set1_ps(t);
+    for (; i + 4 <= a.size(); i += 4) {
+        __m128 ax, ay, az, bx, by, bz;
+        vecmath_detail::vec3Load(a, i, ax, ay, az);
+        vecmath_detail::vec3Load(b, i, bx, by, bz);
+        vecmath_detail::vec3Store(out, i, simdMadd(vt, _mm_sub_ps(bx, ax), ax),
+                                  simdMadd(vt, _mm_sub_ps(by, ay), ay),
+                                  simdMadd(vt, _mm_sub_ps(bz, az), az));
+    }
+#endif
+
+    for (; i < a.size(); ++i) {
+        out.set(i, Vector3f::lerp(a.get(i), b.get(i), t));
+    }
+}
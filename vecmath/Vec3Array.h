@@ -0,0 +1,132 @@
+#ifndef VEC3_ARRAY_H
+#define VEC3_ARRAY_H
+
+#include "vecmath_config.h"
+
+#include <cstddef>
+
+class Vec3Array;
+class Vector3f;
+
+// A non-owning view of n 3D vectors stored as three float lanes, x, y and z,
+// with a common stride (in floats) between consecutive elements.  A
+// Vec3Array is viewed with stride 1; a Vector3f buffer is viewed in place
+// with stride 3, without copying.  Other strides view e.g. a member of an
+// array of structs.
+//
+// Views are passed by value and never own their data.  The array functions
+// below only write through their "out" view.
+class Vec3View {
+  public:
+    constexpr Vec3View(float *x, float *y, float *z, size_t size,
+                       size_t stride = 1)
+        : m_x(x), m_y(y), m_z(z), m_size(size), m_stride(stride) {}
+
+    // views size Vector3f starting at data
+    Vec3View(Vector3f *data, size_t size);
+    Vec3View(const Vector3f *data, size_t size);
+
+    // views all of a, stride 1
+    Vec3View(Vec3Array &a);
+    Vec3View(const Vec3Array &a);
+
+    constexpr size_t size() const { return m_size; }
+    constexpr size_t stride() const { return m_stride; }
+
+    constexpr float *x() const { return m_x; }
+    constexpr float *y() const { return m_y; }
+    constexpr float *z() const { return m_z; }
+
+    Vector3f get(size_t i) const;
+    void set(size_t i, const Vector3f &v) const;
+
+  private:
+    float *m_x;
+    float *m_y;
+    float *m_z;
+    size_t m_size;
+    size_t m_stride;
+};
+
+// A growable array of 3D vectors stored structure-of-arrays: separate x, y
+// and z lanes, each aligned to kAlignment bytes, so that whole-array
+// arithmetic and the SoA transforms in BatchTransform.h run at SIMD width.
+class Vec3Array {
+  public:
+    static constexpr size_t kAlignment = 32;
+
+    Vec3Array();
+    // size zero vectors
+    explicit Vec3Array(size_t size);
+    // copies the elements of v, e.g. a view of a Vector3f buffer
+    explicit Vec3Array(const Vec3View &v);
+
+    Vec3Array(const Vec3Array &a);
+    Vec3Array(Vec3Array &&a) noexcept;
+    Vec3Array &operator=(const Vec3Array &a);
+    Vec3Array &operator=(Vec3Array &&a) noexcept;
+    ~Vec3Array();
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+
+    // new elements are zero
+    void resize(size_t size);
+    void reserve(size_t capacity);
+    void clear() { m_size = 0; }
+    void push_back(const Vector3f &v);
+
+    Vector3f get(size_t i) const;
+    void set(size_t i, const Vector3f &v);
+
+    // the lanes; x()[i], y()[i], z()[i] is element i
+    float *x() { return m_data; }
+    float *y() { return m_data + m_capacity; }
+    float *z() { return m_data + 2 * m_capacity; }
+    const float *x() const { return m_data; }
+    const float *y() const { return m_data + m_capacity; }
+    const float *z() const { return m_data + 2 * m_capacity; }
+
+    // writes all elements to out, which must hold size() Vector3f
+    void copyTo(Vector3f *out) const;
+
+  private:
+    // one allocation holding the three lanes, each m_capacity floats long
+    float *m_data;
+    size_t m_size;
+    size_t m_capacity;
+};
+
+// Whole-array arithmetic.  All views must have the same size.  out may be
+// the same view as an input, but must not otherwise overlap one.
+
+// out[i] = a[i] + b[i]
+void add(const Vec3View &a, const Vec3View &b, const Vec3View &out);
+
+// out[i] = s * a[i]
+void scale(const Vec3View &a, float s, const Vec3View &out);
+
+// out[i] = Vector3f::madd(a[i], s, b[i]), i.e. a[i] * s + b[i]
+void madd(const Vec3View &a, float s, const Vec3View &b, const Vec3View &out);
+
+// out[i] = Vector3f::dot(a[i], b[i]); out holds a.size() floats
+void dot(const Vec3View &a, const Vec3View &b, float *out);
+
+// out[i] = Vector3f::cross(a[i], b[i])
+void cross(const Vec3View &a, const Vec3View &b, const Vec3View &out);
+
+// out[i] = a[i].normalized()
+void normalize(const Vec3View &a, const Vec3View &out);
+
+// out[i] = a[i].normalizedFast(), with the same error bound
+void normalizeFast(const Vec3View &a, const Vec3View &out);
+
+// out[i] = Vector3f::lerp(a[i], b[i], t)
+void lerp(const Vec3View &a, const Vec3View &b, float t, const Vec3View &out);
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Vec3Array.cpp"
+#endif
+
+#endif // VEC3_ARRAY_H
@@ -1,7 +1,10 @@
 #ifndef VECTOR_2F_H
 #define VECTOR_2F_H
 
+#include "vecmath_config.h"
+
 #include <cmath>
+#include <type_traits>
 
 class Vector3f;
 
@@ -11,26 +14,21 @@ class Vector2f {
     static const Vector2f UP;
     static const Vector2f RIGHT;
 
-    Vector2f(float f = 0.f);
-    Vector2f(float x, float y);
-
-    // copy constructors
-    Vector2f(const Vector2f &rv);
-
-    // assignment operators
-    Vector2f &operator=(const Vector2f &rv);
+    constexpr Vector2f(float f = 0.f) : m_elements{f, f} {}
+    constexpr Vector2f(float x, float y) : m_elements{x, y} {}
 
+    // implicit copy constructor and assignment operator (trivially copyable)
     // no destructor necessary
 
     // returns the ith element
-    const float &operator[](int i) const;
-    float &operator[](int i);
+    constexpr const float &operator[](int i) const { return m_elements[i]; }
+    constexpr float &operator[](int i) { return m_elements[i]; }
 
-    float &x();
-    float &y();
+    constexpr float &x() { return m_elements[0]; }
+    constexpr float &y() { return m_elements[1]; }
 
-    float x() const;
-    float y() const;
+    constexpr float x() const { return m_elements[0]; }
+    constexpr float y() const { return m_elements[1]; }
 
     Vector2f xy() const;
     Vector2f yx() const;
@@ -84,4 +82,16 @@ Vector2f operator/(const Vector2f &v, float f);
 bool operator==(const Vector2f &v0, const Vector2f &v1);
 bool operator!=(const Vector2f &v0, const Vector2f &v1);
 
+static_assert(std::is_trivially_copyable<Vector2f>::value,
+              "Vector2f must be trivially copyable");
+static_assert(std::is_standard_layout<Vector2f>::value &&
+                  sizeof(Vector2f) == 2 * sizeof(float),
+              "Vector2f must be laid out as 2 packed floats");
+static_assert(Vector2f(1, 2).y() == 2,
+              "Vector2f must be usable in constant expressions");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Vector2f.cpp"
+#endif
+
 #endif // VECTOR_2F_H
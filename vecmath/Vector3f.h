@@ -1,6 +1,10 @@
 #ifndef VECTOR_3F_H
 #define VECTOR_3F_H
 
+#include "vecmath_config.h"
+
+#include <type_traits>
+
 class Vector2f;
 
 class Vector3f {
@@ -10,31 +14,26 @@ class Vector3f {
     static const Vector3f RIGHT;
     static const Vector3f FORWARD;
 
-    Vector3f(float f = 0.f);
-    Vector3f(float x, float y, float z);
+    constexpr Vector3f(float f = 0.f) : m_elements{f, f, f} {}
+    constexpr Vector3f(float x, float y, float z) : m_elements{x, y, z} {}
 
     Vector3f(const Vector2f &xy, float z);
     Vector3f(float x, const Vector2f &yz);
 
-    // copy constructors
-    Vector3f(const Vector3f &rv);
-
-    // assignment operators
-    Vector3f &operator=(const Vector3f &rv);
-
+    // implicit copy constructor and assignment operator (trivially copyable)
     // no destructor necessary
 
     // returns the ith element
-    const float &operator[](int i) const;
-    float &operator[](int i);
+    constexpr const float &operator[](int i) const { return m_elements[i]; }
+    constexpr float &operator[](int i) { return m_elements[i]; }
 
-    float &x();
-    float &y();
-    float &z();
+    constexpr float &x() { return m_elements[0]; }
+    constexpr float &y() { return m_elements[1]; }
+    constexpr float &z() { return m_elements[2]; }
 
-    float x() const;
-    float y() const;
-    float z() const;
+    constexpr float x() const { return m_elements[0]; }
+    constexpr float y() const { return m_elements[1]; }
+    constexpr float z() const { return m_elements[2]; }
 
     Vector2f xy() const;
     Vector2f xz() const;
@@ -50,6 +49,14 @@ class Vector3f {
     void normalize();
     Vector3f normalized() const;
 
+    // normalized() computed with a reciprocal square root estimate and one
+    // Newton step instead of sqrt and divide.  The result's length is within
+    // 4.8e-7 (2^-21) of 1 and each component within 4.8e-7 of
+    // normalized()'s for lengths whose square is a normal float, i.e. from
+    // sqrt(FLT_MIN) ~ 1.1e-19 to sqrt(FLT_MAX) ~ 1.8e19; outside that range
+    // (zero included) the result is NaN.  Without SIMD it is normalized().
+    Vector3f normalizedFast() const;
+
     Vector2f homogenized() const;
 
     void negate();
@@ -70,6 +77,31 @@ class Vector3f {
     // returns v0 * ( 1 - alpha ) * v1 * alpha
     static Vector3f lerp(const Vector3f &v0, const Vector3f &v1, float alpha);
 
+    // Fused operations, evaluated in one pass without the temporaries of the
+    // equivalent operator expressions.
+
+    // a * s + b
+    static constexpr Vector3f madd(const Vector3f &a, float s,
+                                   const Vector3f &b) {
+        return Vector3f(a[0] * s + b[0], a[1] * s + b[1], a[2] * s + b[2]);
+    }
+
+    // a * b + c, component-wise
+    static constexpr Vector3f madd(const Vector3f &a, const Vector3f &b,
+                                   const Vector3f &c) {
+        return Vector3f(a[0] * b[0] + c[0], a[1] * b[1] + c[1],
+                        a[2] * b[2] + c[2]);
+    }
+
+    // out = lerp(v0, v1, alpha); out may alias v0 or v1
+    static constexpr void lerp(const Vector3f &v0, const Vector3f &v1,
+                               float alpha, Vector3f &out) {
+        float x = alpha * (v1[0] - v0[0]) + v0[0];
+        float y = alpha * (v1[1] - v0[1]) + v0[1];
+        float z = alpha * (v1[2] - v0[2]) + v0[2];
+        out = Vector3f(x, y, z);
+    }
+
     // computes the cubic catmull-rom interpolation between p0, p1, p2, p3
     // by t \in [0,1].  Guarantees that at t = 0, the result is p0 and
     // at p1, the result is p2.
@@ -98,4 +130,16 @@ Vector3f operator/(const Vector3f &v, float f);
 bool operator==(const Vector3f &v0, const Vector3f &v1);
 bool operator!=(const Vector3f &v0, const Vector3f &v1);
 
+static_assert(std::is_trivially_copyable<Vector3f>::value,
+              "Vector3f must be trivially copyable");
+static_assert(std::is_standard_layout<Vector3f>::value &&
+                  sizeof(Vector3f) == 3 * sizeof(float),
+              "Vector3f must be laid out as 3 packed floats");
+static_assert(Vector3f(1, 2, 3).z() == 3,
+              "Vector3f must be usable in constant expressions");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Vector3f.cpp"
+#endif
+
 #endif // VECTOR_3F_H
@@ -1,13 +1,18 @@
 #ifndef VECTOR_4F_H
 #define VECTOR_4F_H
 
+#include "vecmath_config.h"
+
+#include <type_traits>
+
 class Vector2f;
 class Vector3f;
 
 class Vector4f {
   public:
-    Vector4f(float f = 0.f);
-    Vector4f(float fx, float fy, float fz, float fw);
+    constexpr Vector4f(float f = 0.f) : m_elements{f, f, f, f} {}
+    constexpr Vector4f(float fx, float fy, float fz, float fw)
+        : m_elements{fx, fy, fz, fw} {}
     Vector4f(float buffer[4]);
 
     Vector4f(const Vector2f &xy, float z, float w);
@@ -18,27 +23,22 @@ class Vector4f {
     Vector4f(const Vector3f &xyz, float w);
     Vector4f(float x, const Vector3f &yzw);
 
-    // copy constructors
-    Vector4f(const Vector4f &rv);
-
-    // assignment operators
-    Vector4f &operator=(const Vector4f &rv);
-
+    // implicit copy constructor and assignment operator (trivially copyable)
     // no destructor necessary
 
     // returns the ith element
-    const float &operator[](int i) const;
-    float &operator[](int i);
+    constexpr const float &operator[](int i) const { return m_elements[i]; }
+    constexpr float &operator[](int i) { return m_elements[i]; }
 
-    float &x();
-    float &y();
-    float &z();
-    float &w();
+    constexpr float &x() { return m_elements[0]; }
+    constexpr float &y() { return m_elements[1]; }
+    constexpr float &z() { return m_elements[2]; }
+    constexpr float &w() { return m_elements[3]; }
 
-    float x() const;
-    float y() const;
-    float z() const;
-    float w() const;
+    constexpr float x() const { return m_elements[0]; }
+    constexpr float y() const { return m_elements[1]; }
+    constexpr float z() const { return m_elements[2]; }
+    constexpr float w() const { return m_elements[3]; }
 
     Vector2f xy() const;
     Vector2f yz() const;
@@ -95,4 +95,16 @@ Vector4f operator/(const Vector4f &v, float f);
 bool operator==(const Vector4f &v0, const Vector4f &v1);
 bool operator!=(const Vector4f &v0, const Vector4f &v1);
 
+static_assert(std::is_trivially_copyable<Vector4f>::value,
+              "Vector4f must be trivially copyable");
+static_assert(std::is_standard_layout<Vector4f>::value &&
+                  sizeof(Vector4f) == 4 * sizeof(float),
+              "Vector4f must be laid out as 4 packed floats");
+static_assert(Vector4f(1, 2, 3, 4).w() == 4,
+              "Vector4f must be usable in constant expressions");
+
+#ifdef VECMATH_HEADER_ONLY
+#include "Vector4f.cpp"
+#endif
+
 #endif // VECTOR_4F_H
@@ -0,0 +1,197 @@
+#include "VertexCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace vecmath_detail {
+
+// Forsyth's constants: the modelled LRU cache, how fast a vertex's score
+// decays with its age in it, the flat score of the last triangle's three
+// vertices, and the boost for vertices with few triangles left, which keeps
+// the order from stranding lone triangles
+constexpr unsigned vcacheSize = 32;
+constexpr float vcacheDecayPower = 1.5f;
+constexpr float vcacheLastTriangleScore = 0.75f;
+constexpr float vcacheValenceScale = 2.f;
+constexpr float vcacheValencePower = 0.5f;
+// valences from here on score as this one, close enough to nothing
+constexpr unsigned vcacheMaxValence = 32;
+
+// The score of each cache position and remaining valence, tabulated
+struct VcacheScores {
+    float position[vcacheSize + 1]; // the last for "not in the cache"
+    float valence[vcacheMaxValence + 1];
+
+    VcacheScores() {
+        for (unsigned i = 0; i < vcacheSize; ++i) {
+            position[i] =
+                i < 3 ? vcacheLastTriangleScore
+                      : std::pow(1.f - float(i - 3) / (vcacheSize - 3),
+                                 vcacheDecayPower);
+        }
+        position[vcacheSize] = 0.f;
+        valence[0] = -1.f; // never chosen, having nothing left to emit
+        for (unsigned i = 1; i <= vcacheMaxValence; ++i) {
+            valence[i] =
+                vcacheValenceScale * std::pow(float(i), -vcacheValencePower);
+        }
+    }
+
+    float operator()(unsigned cachePos, unsigned remaining) const {
+        if (remaining == 0) {
+            return valence[0];
+        }
+        return position[cachePos] +
+               valence[std::min(remaining, vcacheMaxValence)];
+    }
+};
+
+} // namespace vecmath_detail
+
+VECMATH_INLINE VertexCacheStats analyzeVertexCache(const uint32_t *indices,
+                                                   size_t indexCount,
+                                                   size_t vertexCount,
+                                                   unsigned cacheSize) {
+    VertexCacheStats stats = {0.f, 0.f};
+    if (indexCount < 3 || vertexCount == 0) {
+        return stats;
+    }
+
+    // A vertex is in the FIFO if fewer than cacheSize misses came after the
+    // one that loaded it
+    std::vector<size_t> loadedAt(vertexCount, 0);
+    size_t misses = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        uint32_t v = indices[i];
+        if (loadedAt[v] == 0 || misses - loadedAt[v] >= cacheSize) {
+            loadedAt[v] = ++misses;
+        }
+    }
+
+    stats.acmr = float(misses) / float(indexCount / 3);
+    stats.atvr = float(misses) / float(vertexCount);
+    return stats;
+}
+
+VECMATH_INLINE void optimizeVertexCache(const uint32_t *indices,
+                                        uint32_t *out, size_t indexCount,
+                                        size_t vertexCount) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+    std::vector<uint32_t> copy;
+    if (out == indices) {
+        copy.assign(indices, indices + 3 * triangleCount);
+        indices = copy.data();
+    }
+
+    // the triangles left at each vertex: adjacency[first[v]] on, remaining[v]
+    // of them, with emitted ones swapped out past the end
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < 3 * triangleCount; ++i) {
+        ++remaining[indices[i]];
+    }
+    std::vector<size_t> first(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        first[v + 1] = first[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(3 * triangleCount);
+    {
+        std::vector<size_t> fill(first.begin(), first.end() - 1);
+        for (size_t i = 0; i < 3 * triangleCount; ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    static const vecmath_detail::VcacheScores scoreOf;
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        score[v] = scoreOf(vecmath_detail::vcacheSize, remaining[v]);
+    }
+    std::vector<bool> emitted(triangleCount, false);
+
+    // the LRU cache, most recent first, and room to build the next one: the
+    // last triangle's vertices, then the rest of the old cache
+    uint32_t cache[vecmath_detail::vcacheSize + 3];
+    uint32_t nextCache[vecmath_detail::vcacheSize + 3];
+    unsigned cacheCount = 0;
+
+    size_t best = 0; // the first triangle, for want of a better
+    size_t scan = 0;
+    for (size_t k = 0; k < triangleCount; ++k) {
+        if (best == triangleCount) {
+            // nothing in the cache has triangles left: take the next one
+            // in the input
+            while (emitted[scan]) {
+                ++scan;
+            }
+            best = scan;
+        }
+
+        const uint32_t *tri = indices + 3 * best;
+        std::copy(tri, tri + 3, out + 3 * k);
+        emitted[best] = true;
+
+        unsigned nextCount = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t v = tri[corner];
+            uint32_t *list = &adjacency[first[v]];
+            uint32_t *end = list + remaining[v];
+            *std::find(list, end, static_cast<uint32_t>(best)) = end[-1];
+            --remaining[v];
+            if (std::find(nextCache, nextCache + nextCount, v) ==
+                nextCache + nextCount) {
+                nextCache[nextCount++] = v;
+            }
+        }
+        for (unsigned i = 0; i < cacheCount; ++i) {
+            uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                nextCache[nextCount++] = v;
+            }
+        }
+
+        // rescore the vertices that moved, including any that fell out
+        for (unsigned i = 0; i < nextCount; ++i) {
+            uint32_t v = nextCache[i];
+            score[v] =
+                scoreOf(std::min(i, vecmath_detail::vcacheSize), remaining[v]);
+        }
+        cacheCount = std::min(nextCount, vecmath_detail::vcacheSize);
+        std::copy(nextCache, nextCache + cacheCount, cache);
+
+        // the next triangle: the best one touching the cache
+        best = triangleCount;
+        float bestScore = -1.f;
+        for (unsigned i = 0; i < cacheCount; ++i) {
+            uint32_t v = cache[i];
+            const uint32_t *list = &adjacency[first[v]];
+            for (uint32_t j = 0; j < remaining[v]; ++j) {
+                const uint32_t *t = indices + 3 * size_t(list[j]);
+                float s = score[t[0]] + score[t[1]] + score[t[2]];
+                if (s > bestScore) {
+                    bestScore = s;
+                    best = list[j];
+                }
+            }
+        }
+    }
+}
+
+VECMATH_INLINE size_t optimizeVertexFetch(uint32_t *indices,
+                                          size_t indexCount,
+                                          size_t vertexCount,
+                                          uint32_t *remap) {
+    std::fill(remap, remap + vertexCount, UNUSED_VERTEX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        uint32_t &v = remap[indices[i]];
+        if (v == UNUSED_VERTEX) {
+            v = next++;
+        }
+        indices[i] = v;
+    }
+    return next;
+}
@@ -0,0 +1,67 @@
+#ifndef VERTEXCACHE_H
+#define VERTEXCACHE_H
+
+#include "vecmath_config.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Triangle and vertex order for indexed triangle lists, three indices per
+// triangle.  The GPU keeps the transformed results of the last few vertices
+// it ran and reuses them when an index repeats soon enough, so the order of
+// the triangles decides how many vertices are transformed; the order of the
+// vertices decides how scattered the fetches of their attributes are.
+
+// How well an order uses the cache
+struct VertexCacheStats {
+    // vertices transformed per triangle: 3 at worst, about 0.5 at best for
+    // a large regular mesh
+    float acmr;
+    // vertices transformed per vertex: 1 at best
+    float atvr;
+};
+
+// Replays indices through a FIFO cache of cacheSize vertices; vertexCount
+// bounds the indices
+VertexCacheStats analyzeVertexCache(const uint32_t *indices,
+                                    size_t indexCount, size_t vertexCount,
+                                    unsigned cacheSize = 16);
+
+// Writes the triangles of indices to out in an order that reuses the cache,
+// with Forsyth's "Linear-Speed Vertex Cache Optimisation": each step emits
+// the best-scoring triangle that has a vertex in a modelled 32-entry LRU
+// cache, a vertex scoring higher the more recently it was used and the fewer
+// triangles it has left.  The order suits any cache size, so it needs no
+// tuning for the GPU.  out may be indices.
+void optimizeVertexCache(const uint32_t *indices, uint32_t *out,
+                         size_t indexCount, size_t vertexCount);
+
+// the remap entry of a vertex no triangle uses
+constexpr uint32_t UNUSED_VERTEX = 0xffffffff;
+
+// Renumbers the vertices in the order indices first use them, rewriting
+// indices in place, so that drawing walks the vertex arrays nearly in
+// order.  remap, of vertexCount entries, receives each old vertex's new
+// number, or UNUSED_VERTEX; apply it to the vertex arrays with
+// remapVertices.  Returns the number of vertices used.
+size_t optimizeVertexFetch(uint32_t *indices, size_t indexCount,
+                           size_t vertexCount, uint32_t *remap);
+
+// Moves in[i] to out[remap[i]] for the vertexCount vertices, dropping
+// unused ones; out, which must not overlap in, has room for the count
+// optimizeVertexFetch returned
+template <typename T>
+void remapVertices(const T *in, T *out, size_t vertexCount,
+                   const uint32_t *remap) {
+    for (size_t i = 0; i < vertexCount; ++i) {
+        if (remap[i] != UNUSED_VERTEX) {
+            out[remap[i]] = in[i];
+        }
+    }
+}
+
+#ifdef VECMATH_HEADER_ONLY
+#include "VertexCache.cpp"
+#endif
+
+#endif // VERTEXCACHE_H
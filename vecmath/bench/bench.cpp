@@ -0,0 +1,750 @@
+#include <vecmath.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+#ifdef VECMATH_HEADER_ONLY
+const char *kMode = "header-only";
+#else
+const char *kMode = "libvecmath.a";
+#endif
+
+// One measurement, for the --json report: a timing (kind "throughput" or
+// "latency", set naming the working set) or an accuracy check.
+struct Result {
+    string name;
+    string kind;
+    string set;
+    size_t items;
+    vector<pair<string, double>> values;
+};
+
+vector<Result> gResults;
+
+// Writes gResults as one JSON object; returns false if path can't be written
+bool writeJson(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return false;
+    }
+
+    fprintf(f, "{\n  \"mode\": \"%s\",\n  \"simd\": \"%s\",\n", kMode,
+            getSimdLevelName(getSimdLevel()));
+    fprintf(f, "  \"results\": [");
+    for (size_t i = 0; i < gResults.size(); ++i) {
+        const Result &r = gResults[i];
+        // the names are plain literals: no quotes or backslashes to escape
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"kind\": \"%s\"",
+                i ? "," : "", r.name.c_str(), r.kind.c_str());
+        if (!r.set.empty()) {
+            fprintf(f, ", \"set\": \"%s\", \"items\": %zu", r.set.c_str(),
+                    r.items);
+        }
+        for (const auto &v : r.values) {
+            fprintf(f, ", \"%s\": %.6g", v.first.c_str(), v.second);
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+// Runs fn() until at least minSeconds have passed and reports the best
+// time per item over all repetitions.  fn returns the number of items it
+// processed; for kind "latency" each item depends on the one before.
+template <typename F>
+void run(const char *name, F fn, const char *set = "cache",
+         const char *kind = "throughput", double minSeconds = 0.5) {
+    using clock = chrono::steady_clock;
+
+    double best = 1e30;
+    size_t items = 0;
+    auto start = clock::now();
+
+    do {
+        auto t0 = clock::now();
+        items = fn();
+        auto t1 = clock::now();
+        best = min(best, chrono::duration<double, nano>(t1 - t0).count());
+    } while (chrono::duration<double>(clock::now() - start).count() <
+             minSeconds);
+
+    printf("%-32s %-14s %-5s %-10s %9zu items %9.2f ns/item\n", name, kMode,
+           set, kind, items, best / items);
+    gResults.push_back(
+        {name, kind, set, items, {{"ns_per_item", best / items}}});
+}
+
+// n vectors with random directions and lengths spread log-uniformly over
+// [10^minExp, 10^maxExp]
+vector<Vector3f> randomVectors(size_t n, float minExp, float maxExp) {
+    mt19937 rng(1);
+    normal_distribution<float> direction;
+    uniform_real_distribution<float> exponent(minExp, maxExp);
+
+    vector<Vector3f> v(n);
+    for (auto &x : v) {
+        Vector3f d(direction(rng), direction(rng), direction(rng));
+        x = pow(10.f, exponent(rng)) * d.normalized();
+    }
+    return v;
+}
+
+// Largest error of out[i] as the normalization of in[i]: of its length
+// against 1 and of its components against a double precision reference.
+void accuracy(const char *name, const vector<Vector3f> &in,
+              const vector<Vector3f> &out) {
+    double lengthError = 0;
+    double componentError = 0;
+    for (size_t i = 0; i < in.size(); ++i) {
+        double x = in[i][0], y = in[i][1], z = in[i][2];
+        double length = sqrt(x * x + y * y + z * z);
+        double ox = out[i][0], oy = out[i][1], oz = out[i][2];
+
+        lengthError =
+            max(lengthError, fabs(sqrt(ox * ox + oy * oy + oz * oz) - 1));
+        componentError = max({componentError, fabs(ox - x / length),
+                              fabs(oy - y / length), fabs(oz - z / length)});
+    }
+    printf("%-32s max |length - 1| %.3g, max component error %.3g\n", name,
+           lengthError, componentError);
+    gResults.push_back({name, "accuracy", "", 0,
+                        {{"max_length_error", lengthError},
+                         {"max_component_error", componentError}}});
+}
+
+// Largest and mean angle between in[i] and its round trip through the
+// octahedral encoding O, in degrees.  atan2 keeps small angles accurate.
+template <typename O>
+void octError(const char *name, const vector<Vector3f> &in) {
+    vector<O> packed(in.size());
+    vector<Vector3f> out(in.size());
+    encodeNormals(in.data(), packed.data(), in.size());
+    decodeNormals(packed.data(), out.data(), in.size());
+
+    double maxError = 0;
+    double sumError = 0;
+    for (size_t i = 0; i < in.size(); ++i) {
+        double x = in[i][0], y = in[i][1], z = in[i][2];
+        double ox = out[i][0], oy = out[i][1], oz = out[i][2];
+        double cx = y * oz - z * oy, cy = z * ox - x * oz, cz = x * oy - y * ox;
+        double angle = atan2(sqrt(cx * cx + cy * cy + cz * cz),
+                             x * ox + y * oy + z * oz);
+        maxError = max(maxError, angle);
+        sumError += angle;
+    }
+    double meanError = sumError / in.size();
+    printf("%-32s max error %.3g deg, mean %.3g deg\n", name,
+           maxError * 180 / M_PI, meanError * 180 / M_PI);
+    gResults.push_back({name, "accuracy", "", 0,
+                        {{"max_error_deg", maxError * 180 / M_PI},
+                         {"mean_error_deg", meanError * 180 / M_PI}}});
+}
+
+// n matrices with entries uniform in [-1, 1]: almost surely invertible
+template <typename M>
+vector<M> randomMatrices(size_t n, int size, mt19937 &rng) {
+    uniform_real_distribution<float> u(-1, 1);
+    vector<M> m(n);
+    for (auto &x : m) {
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                x(i, j) = u(rng);
+            }
+        }
+    }
+    return m;
+}
+
+// n random rotations from rng
+vector<Quat4f> randomRotations(size_t n, mt19937 &rng) {
+    uniform_real_distribution<float> u;
+    vector<Quat4f> q(n);
+    for (auto &x : q) {
+        x = Quat4f::randomRotation(u(rng), u(rng), u(rng));
+    }
+    return q;
+}
+
+// Largest component difference of batch[i] from one[i], up to sign
+void agreement(const char *name, const vector<Quat4f> &batch,
+               const vector<Quat4f> &one) {
+    float error = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        float plus = 0;
+        float minus = 0;
+        for (int j = 0; j < 4; ++j) {
+            plus = max(plus, fabs(batch[i][j] - one[i][j]));
+            minus = max(minus, fabs(batch[i][j] + one[i][j]));
+        }
+        error = max(error, min(plus, minus));
+    }
+    printf("%-32s max component difference %.3g\n", name, error);
+    gResults.push_back(
+        {name, "accuracy", "", 0, {{"max_component_difference", error}}});
+}
+
+// Working sets for the core primitives, by the level of the memory
+// hierarchy they should live in: the inputs and output of one timed loop
+// take about this many bytes.
+struct Tier {
+    const char *name;
+    size_t bytes;
+};
+
+const Tier kTiers[] = {{"L1", 16 << 10}, {"L2", 256 << 10}, {"DRAM", 64 << 20}};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const char *jsonPath = NULL;
+    if (argc == 3 && strcmp(argv[1], "--json") == 0) {
+        jsonPath = argv[2];
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [--json FILE]\n", argv[0]);
+        return 2;
+    }
+
+    const size_t n = 1 << 20;
+
+    // accuracy over lengths 1e-15 .. 1e15 (squared lengths stay normal)
+    auto wide = randomVectors(n, -15, 15);
+    vector<Vector3f> out(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = wide[i].normalized();
+    }
+    accuracy("normalized", wide, out);
+
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = wide[i].normalizedFast();
+    }
+    accuracy("normalizedFast", wide, out);
+
+    normalize(Vec3View(wide.data(), n), Vec3View(out.data(), n));
+    accuracy("normalize (array)", wide, out);
+
+    normalizeFast(Vec3View(wide.data(), n), Vec3View(out.data(), n));
+    accuracy("normalizeFast (array)", wide, out);
+
+    octError<OctNormal32>("OctNormal32 round trip", wide);
+    octError<OctNormal16>("OctNormal16 round trip", wide);
+
+    // sinCos over [-1000, 1000] against double precision
+    vector<float> angles(n);
+    vector<float> sines(n);
+    vector<float> cosines(n);
+    for (size_t i = 0; i < n; ++i) {
+        angles[i] = 1000.f * wide[i][0] / wide[i].abs();
+    }
+    sinCos(angles.data(), sines.data(), cosines.data(), n);
+    double trigError = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double a = angles[i];
+        trigError = max({trigError, fabs(sines[i] - sin(a)),
+                         fabs(cosines[i] - cos(a))});
+    }
+    printf("%-32s max error %.3g\n", "sinCos", trigError);
+    gResults.push_back(
+        {"sinCos", "accuracy", "", 0, {{"max_error", trigError}}});
+
+    // throughput, on a cache-resident working set
+    const size_t m = 4096;
+    auto in = randomVectors(m, -2, 2);
+    Vec3Array soa(Vec3View(in.data(), m));
+    Vec3Array soaOut(m);
+
+    run("normalized", [&] {
+        for (size_t i = 0; i < m; ++i) {
+            out[i] = in[i].normalized();
+        }
+        return m;
+    });
+    run("normalizedFast", [&] {
+        for (size_t i = 0; i < m; ++i) {
+            out[i] = in[i].normalizedFast();
+        }
+        return m;
+    });
+    run("normalize (Vector3f array)", [&] {
+        normalize(Vec3View(in.data(), m), Vec3View(out.data(), m));
+        return m;
+    });
+    run("normalizeFast (Vector3f array)", [&] {
+        normalizeFast(Vec3View(in.data(), m), Vec3View(out.data(), m));
+        return m;
+    });
+    run("normalize (Vec3Array)", [&] {
+        normalize(soa, soaOut);
+        return m;
+    });
+    run("normalizeFast (Vec3Array)", [&] {
+        normalizeFast(soa, soaOut);
+        return m;
+    });
+
+    // quaternion interpolation: pairs 0 to 180 degrees apart
+    mt19937 rng(2);
+    uniform_real_distribution<float> u;
+    auto qa = randomRotations(m, rng);
+    auto qb = randomRotations(m, rng);
+    vector<float> qt(m);
+    for (auto &t : qt) {
+        t = u(rng);
+    }
+    vector<Quat4f> qOut(m);
+    vector<Quat4f> qOne(m);
+
+    slerp(qa.data(), qb.data(), qt.data(), qOut.data(), m);
+    for (size_t i = 0; i < m; ++i) {
+        // Quat4f::slerp does not renormalize pairs it lerps
+        qOne[i] = Quat4f::slerp(qa[i], qb[i], qt[i]).normalized();
+    }
+    agreement("slerp vs Quat4f::slerp", qOut, qOne);
+
+    // a smooth 64 key track sampled at m times
+    const size_t nKeys = 64;
+    vector<Quat4f> keys(nKeys);
+    keys[0] = Quat4f::IDENTITY;
+    for (size_t k = 1; k < nKeys; ++k) {
+        Quat4f step;
+        step.setAxisAngle(0.5f, Vector3f(u(rng), u(rng), u(rng) + 0.1f));
+        keys[k] = keys[k - 1] * step;
+    }
+    vector<Quat4f> tangents(nKeys);
+    squadTangents(keys.data(), nKeys, tangents.data());
+    vector<float> times(m);
+    for (size_t i = 0; i < m; ++i) {
+        times[i] = (nKeys - 1) * static_cast<float>(i) / m;
+    }
+    vector<Matrix3f> mOut(m);
+
+    sampleSquad(keys.data(), tangents.data(), nKeys, times.data(),
+                qOut.data(), m);
+    for (size_t i = 0; i < m; ++i) {
+        size_t k = static_cast<size_t>(times[i]);
+        qOne[i] = Quat4f::squad(keys[k], tangents[k], tangents[k + 1],
+                                keys[k + 1], times[i] - k);
+    }
+    agreement("sampleSquad vs Quat4f::squad", qOut, qOne);
+
+    run("Quat4f::slerp", [&] {
+        for (size_t i = 0; i < m; ++i) {
+            qOut[i] = Quat4f::slerp(qa[i], qb[i], qt[i]);
+        }
+        return m;
+    });
+    run("slerp (array)", [&] {
+        slerp(qa.data(), qb.data(), qt.data(), qOut.data(), m);
+        return m;
+    });
+    run("nlerp (array)", [&] {
+        nlerp(qa.data(), qb.data(), qt.data(), qOut.data(), m);
+        return m;
+    });
+    run("Quat4f::squad + rotation", [&] {
+        for (size_t i = 0; i < m; ++i) {
+            size_t k = static_cast<size_t>(times[i]);
+            mOut[i] = Matrix3f::rotation(
+                Quat4f::squad(keys[k], tangents[k], tangents[k + 1],
+                              keys[k + 1], times[i] - k));
+        }
+        return m;
+    });
+    run("sampleSquad (Matrix3f)", [&] {
+        sampleSquad(keys.data(), tangents.data(), nKeys, times.data(),
+                    mOut.data(), m);
+        return m;
+    });
+
+    // bounding volumes
+    // each run extends the previous result, so the compiler cannot hoist it
+    Box3f box;
+    run("Box3f::extend (loop)", [&] {
+        for (size_t i = 0; i < m; ++i) {
+            box.extend(in[i]);
+        }
+        return m;
+    });
+    run("Box3f::fromPoints", [&] {
+        box.extend(Box3f::fromPoints(in.data(), in.size()));
+        return m;
+    });
+    Sphere3f sphere;
+    run("Sphere3f::fromPoints", [&] {
+        sphere = Sphere3f::fromPoints(in.data(), m);
+        return m;
+    });
+
+    // m small boxes and spheres around in[i], against a camera at the origin
+    Frustum frustum(
+        Matrix4f::perspectiveProjection(1.f, 1.5f, 0.1f, 50.f, false) *
+        Matrix4f::lookAt(Vector3f(0), Vector3f(1, 1, -1), Vector3f(0, 1, 0)));
+    vector<Box3f> boxes(m);
+    vector<Sphere3f> spheres(m);
+    for (size_t i = 0; i < m; ++i) {
+        boxes[i] = Box3f(in[i] - Vector3f(0.1f), in[i] + Vector3f(0.1f));
+        spheres[i] = Sphere3f(in[i], 0.1f);
+    }
+    size_t visible = 0;
+    run("Frustum::intersects (Box3f)", [&] {
+        visible = 0;
+        for (auto &b : boxes) {
+            visible += frustum.intersects(b);
+        }
+        return m;
+    });
+    run("Frustum::intersects (Sphere3f)", [&] {
+        visible = 0;
+        for (auto &s : spheres) {
+            visible += frustum.intersects(s);
+        }
+        return m;
+    });
+    run("Box3f::intersectRay", [&] {
+        visible = 0;
+        for (size_t i = 0; i < m; ++i) {
+            visible += boxes[i].intersectRay(Vector3f(0), in[(i + 1) % m]);
+        }
+        return m;
+    });
+
+    // octahedral normals
+    vector<OctNormal32> oct32(m);
+    vector<OctNormal16> oct16(m);
+    run("OctNormal32 (loop)", [&] {
+        for (size_t i = 0; i < m; ++i) {
+            oct32[i] = OctNormal32(in[i]);
+        }
+        return m;
+    });
+    run("encodeNormals (OctNormal32)", [&] {
+        encodeNormals(in.data(), oct32.data(), m);
+        return m;
+    });
+    run("decodeNormals (OctNormal32)", [&] {
+        decodeNormals(oct32.data(), out.data(), m);
+        return m;
+    });
+    run("encodeNormals (OctNormal16)", [&] {
+        encodeNormals(in.data(), oct16.data(), m);
+        return m;
+    });
+    run("decodeNormals (OctNormal16)", [&] {
+        decodeNormals(oct16.data(), out.data(), m);
+        return m;
+    });
+
+    // sines, cosines and rotations about y, e.g. for a surface of revolution
+    vector<Matrix3f> rotationsY(m);
+    const float angleStep = 2 * M_PI / m;
+    for (size_t i = 0; i < m; ++i) {
+        angles[i] = i * angleStep;
+    }
+    run("sin, cos (loop)", [&] {
+        for (size_t i = 0; i < m; ++i) {
+            sines[i] = sin(angles[i]);
+            cosines[i] = cos(angles[i]);
+        }
+        return m;
+    });
+    run("sinCos", [&] {
+        sinCos(angles.data(), sines.data(), cosines.data(), m);
+        return m;
+    });
+    run("sinCosSteps", [&] {
+        sinCosSteps(0.f, angleStep, sines.data(), cosines.data(), m);
+        return m;
+    });
+    run("Matrix3f::rotateY (loop)", [&] {
+        for (size_t i = 0; i < m; ++i) {
+            rotationsY[i] = Matrix3f::rotateY(angles[i]);
+        }
+        return m;
+    });
+    run("Matrix3f::rotationsAboutY", [&] {
+        Matrix3f::rotationsAboutY(angles.data(), rotationsY.data(), m);
+        return m;
+    });
+    run("Matrix3f::rotationsAboutY (step)", [&] {
+        Matrix3f::rotationsAboutY(0.f, angleStep, rotationsY.data(), m);
+        return m;
+    });
+
+    // a transform hierarchy of m nodes, four children each: moving the root
+    // recomputes every world transform, moving a leaf just its own
+    TransformHierarchy hierarchy;
+    hierarchy.reserve(m);
+    for (size_t i = 0; i < m; ++i) {
+        hierarchy.addNode(
+            Affine3f::rotation(in[i], 0.1f) * Affine3f::translation(in[i]),
+            i == 0 ? TransformHierarchy::NO_PARENT : (i - 1) / 4);
+    }
+    vector<Matrix4f> worldMatrices(m);
+    Affine3f spin = Affine3f::rotation(Vector3f(0, 1, 0), 0.01f);
+    run("TransformHierarchy (root moved)", [&] {
+        hierarchy.setLocal(0, spin * hierarchy.getLocal(0));
+        hierarchy.update();
+        return m;
+    });
+    run("TransformHierarchy (leaf moved)", [&] {
+        hierarchy.setLocal(m - 1, spin * hierarchy.getLocal(m - 1));
+        return hierarchy.update();
+    });
+    run("getWorldMatrices", [&] {
+        hierarchy.getWorldMatrices(worldMatrices.data());
+        return m;
+    });
+
+    // core primitives; a short minimum time, as there are many of them
+    const double tierSeconds = 0.25;
+    for (const Tier &tier : kTiers) {
+        auto runTier = [&](const char *name, auto fn) {
+            run(name, fn, tier.name, "throughput", tierSeconds);
+        };
+
+        size_t nv = tier.bytes / (3 * sizeof(Vector3f));
+        auto va = randomVectors(nv, -1, 1);
+        auto vb = randomVectors(nv, -1, 1);
+        vector<Vector3f> vc(nv);
+        vector<float> d(nv);
+        runTier("Vector3f +", [&] {
+            for (size_t i = 0; i < nv; ++i) {
+                vc[i] = va[i] + vb[i];
+            }
+            return nv;
+        });
+        runTier("Vector3f::dot", [&] {
+            for (size_t i = 0; i < nv; ++i) {
+                d[i] = Vector3f::dot(va[i], vb[i]);
+            }
+            return nv;
+        });
+        runTier("Vector3f::cross", [&] {
+            for (size_t i = 0; i < nv; ++i) {
+                vc[i] = Vector3f::cross(va[i], vb[i]);
+            }
+            return nv;
+        });
+        runTier("Vector3f::normalized", [&] {
+            for (size_t i = 0; i < nv; ++i) {
+                vc[i] = va[i].normalized();
+            }
+            return nv;
+        });
+        runTier("normalize (Vector3f array)", [&] {
+            normalize(Vec3View(va.data(), nv), Vec3View(vc.data(), nv));
+            return nv;
+        });
+
+        size_t n3 = tier.bytes / (3 * sizeof(Matrix3f));
+        auto ma = randomMatrices<Matrix3f>(n3, 3, rng);
+        auto mb = randomMatrices<Matrix3f>(n3, 3, rng);
+        vector<Matrix3f> mc(n3);
+        auto qs = randomRotations(n3, rng);
+        auto qs2 = randomRotations(n3, rng);
+        vector<Quat4f> qc(n3);
+        vector<Matrix3f> rotations(n3);
+        for (size_t i = 0; i < n3; ++i) {
+            rotations[i] = Matrix3f::rotation(qs[i]);
+        }
+        d.resize(max(nv, n3));
+        runTier("Matrix3f * Matrix3f", [&] {
+            for (size_t i = 0; i < n3; ++i) {
+                mc[i] = ma[i] * mb[i];
+            }
+            return n3;
+        });
+        runTier("Matrix3f::inverse", [&] {
+            for (size_t i = 0; i < n3; ++i) {
+                mc[i] = ma[i].inverse();
+            }
+            return n3;
+        });
+        runTier("Matrix3f::determinant", [&] {
+            for (size_t i = 0; i < n3; ++i) {
+                d[i] = ma[i].determinant();
+            }
+            return n3;
+        });
+        runTier("Matrix3f::rotation (Quat4f)", [&] {
+            for (size_t i = 0; i < n3; ++i) {
+                mc[i] = Matrix3f::rotation(qs[i]);
+            }
+            return n3;
+        });
+        runTier("Quat4f::fromRotationMatrix", [&] {
+            for (size_t i = 0; i < n3; ++i) {
+                qc[i] = Quat4f::fromRotationMatrix(rotations[i]);
+            }
+            return n3;
+        });
+        runTier("Quat4f::slerp", [&] {
+            for (size_t i = 0; i < n3; ++i) {
+                qc[i] = Quat4f::slerp(qs[i], qs2[i], 0.3f);
+            }
+            return n3;
+        });
+
+        size_t n4 = tier.bytes / (3 * sizeof(Matrix4f));
+        auto m4a = randomMatrices<Matrix4f>(n4, 4, rng);
+        auto m4b = randomMatrices<Matrix4f>(n4, 4, rng);
+        vector<Matrix4f> m4c(n4);
+        runTier("Matrix4f * Matrix4f", [&] {
+            for (size_t i = 0; i < n4; ++i) {
+                m4c[i] = m4a[i] * m4b[i];
+            }
+            return n4;
+        });
+        runTier("Matrix4f::inverse", [&] {
+            for (size_t i = 0; i < n4; ++i) {
+                m4c[i] = m4a[i].inverse();
+            }
+            return n4;
+        });
+        runTier("Matrix4f::determinant", [&] {
+            for (size_t i = 0; i < n4; ++i) {
+                d[i] = m4a[i].determinant();
+            }
+            return n4;
+        });
+    }
+
+    // the dispatched kernels at every level this CPU supports
+    const SimdLevel defaultLevel = getSimdLevel();
+    Matrix4f affine = Matrix4f::translation(Vector3f(1, 2, 3)) *
+                      Matrix4f::rotation(Vector3f(0, 1, 0), 0.5f);
+    auto ka = randomMatrices<Matrix4f>(m, 4, rng);
+    auto kb = randomMatrices<Matrix4f>(m, 4, rng);
+    vector<Matrix4f> kc(m);
+    for (int level = SIMD_SSE2; level <= SIMD_AVX512; ++level) {
+        if (!setSimdLevel(SimdLevel(level))) {
+            continue;
+        }
+        string suffix = string(" [") + getSimdLevelName(SimdLevel(level)) + "]";
+        auto runLevel = [&](const char *name, auto fn) {
+            run((name + suffix).c_str(), fn);
+        };
+        runLevel("transformPoints (AoS)", [&] {
+            transformPoints(affine, in.data(), out.data(), m);
+            return m;
+        });
+        runLevel("transformPoints (SoA)", [&] {
+            transformPoints(affine, soa.x(), soa.y(), soa.z(), soaOut.x(),
+                            soaOut.y(), soaOut.z(), m);
+            return m;
+        });
+        runLevel("normalize (AoS)", [&] {
+            normalize(Vec3View(in.data(), m), Vec3View(out.data(), m));
+            return m;
+        });
+        runLevel("normalizeFast (SoA)", [&] {
+            normalizeFast(soa, soaOut);
+            return m;
+        });
+        runLevel("Matrix4f * Matrix4f", [&] {
+            for (size_t i = 0; i < m; ++i) {
+                kc[i] = ka[i] * kb[i];
+            }
+            return m;
+        });
+        runLevel("Matrix4f::inverse", [&] {
+            for (size_t i = 0; i < m; ++i) {
+                kc[i] = ka[i].inverse();
+            }
+            return m;
+        });
+    }
+    setSimdLevel(defaultLevel);
+
+    // latency: each operation takes the previous one's result, so the time
+    // is the length of the dependency chain rather than the issue rate
+    const size_t chain = 1024;
+    auto runLatency = [&](const char *name, auto fn) {
+        run(name, fn, "L1", "latency", tierSeconds);
+    };
+    float sink = 0;
+    Vector3f axis = Vector3f(0.3f, 0.5f, 0.8f).normalized();
+    runLatency("Vector3f::cross + normalized", [&] {
+        Vector3f v(1, 0, 0);
+        for (size_t i = 0; i < chain; ++i) {
+            v = Vector3f::cross(v, axis).normalized();
+        }
+        sink += v[0];
+        return chain;
+    });
+    Matrix3f r3 = Matrix3f::rotation(axis, 0.1f);
+    runLatency("Matrix3f * Matrix3f", [&] {
+        Matrix3f x = r3;
+        for (size_t i = 0; i < chain; ++i) {
+            x = x * r3;
+        }
+        sink += x(0, 0);
+        return chain;
+    });
+    runLatency("Matrix3f::inverse", [&] {
+        Matrix3f x = r3;
+        for (size_t i = 0; i < chain; ++i) {
+            x = x.inverse();
+        }
+        sink += x(0, 0);
+        return chain;
+    });
+    Matrix4f r4 = Matrix4f::rotation(axis, 0.1f);
+    runLatency("Matrix4f * Matrix4f", [&] {
+        Matrix4f x = r4;
+        for (size_t i = 0; i < chain; ++i) {
+            x = x * r4;
+        }
+        sink += x(0, 0);
+        return chain;
+    });
+    runLatency("Matrix4f::inverse", [&] {
+        Matrix4f x = r4;
+        for (size_t i = 0; i < chain; ++i) {
+            x = x.inverse();
+        }
+        sink += x(0, 0);
+        return chain;
+    });
+    runLatency("Quat4f::slerp", [&] {
+        Quat4f q = Quat4f::IDENTITY;
+        for (size_t i = 0; i < chain; ++i) {
+            q = Quat4f::slerp(q, qa[i], 0.3f);
+        }
+        sink += q[0];
+        return chain;
+    });
+    Quat4f step;
+    step.setAxisAngle(0.1f, axis);
+    runLatency("rotation + fromRotationMatrix", [&] {
+        Quat4f q = Quat4f::IDENTITY;
+        for (size_t i = 0; i < chain; ++i) {
+            q = Quat4f::fromRotationMatrix(Matrix3f::rotation(q * step));
+        }
+        sink += q[0];
+        return chain;
+    });
+
+    printf("(%zu visible, box %g..%g, sphere r %g, chains %g)\n",
+           visible, box.getMin()[0], box.getMax()[0], sphere.getRadius(),
+           sink);
+
+    if (jsonPath != NULL && !writeJson(jsonPath)) {
+        perror(jsonPath);
+        return 1;
+    }
+
+    return 0;
+}
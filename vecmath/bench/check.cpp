@@ -0,0 +1,262 @@
+#include <vecmath.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// Checks the SIMD Matrix4f * Matrix4f, Matrix4f * Vector4f and
+// Matrix4f::inverse against the portable scalar code.  This file builds
+// twice: check_scalar, header-only with VECMATH_NO_SIMD, writes the scalar
+// results for a fixed set of inputs to stdout, and check_simd, linked
+// against libvecmath.a, reads them from stdin and compares its own at every
+// SIMD level this CPU supports:
+//
+//   ./check_scalar | ./check_simd
+//
+// check_simd prints the first mismatches of each kind and exits with status
+// 1 if there are any.
+
+namespace {
+
+const size_t kCount = 100000;
+
+// Tolerances, in FLT_EPSILON.  A product element may differ from the
+// scalar one by kProductTolerance times the sum of the magnitudes of its
+// terms: AVX2 and AVX-512 fuse multiply-adds, skipping up to three of the
+// scalar code's roundings (the SSE2 kernel sums in the scalar order and is
+// exact).  An inverse element may differ by kInverseTolerance times the
+// condition number (infinity norm) times the largest element of the
+// inverse, as Cramer's rule and the cofactor expansion round differently.
+const float kProductTolerance = 4;
+const float kInverseTolerance = 4;
+
+// singular inputs must be reported so at this epsilon; the entries are at
+// most 1, so the rounding of an exact 0 determinant is far below it
+const float kSingularEpsilon = 1e-5f;
+
+// The inputs, generated identically by both builds
+struct Inputs {
+    vector<Matrix4f> a;
+    vector<Matrix4f> b;
+    vector<Vector4f> v;
+    vector<Matrix4f> singular; // a with row 3 replaced by row 1
+};
+
+Inputs makeInputs() {
+    mt19937 rng(3);
+    uniform_real_distribution<float> u(-1, 1);
+    Inputs in;
+    in.a.resize(kCount);
+    in.b.resize(kCount);
+    in.v.resize(kCount);
+    in.singular.resize(kCount);
+    for (size_t n = 0; n < kCount; ++n) {
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                in.a[n](i, j) = u(rng);
+                in.b[n](i, j) = u(rng);
+            }
+            in.v[n][i] = u(rng);
+        }
+        in.singular[n] = in.a[n];
+        in.singular[n].setRow(3, in.a[n].getRow(1));
+    }
+    return in;
+}
+
+// Per input a * b, a * v and a's inverse (16 + 4 + 16 floats), then 1 for
+// each singular input reported as singular and 0 for each not
+const size_t kPerInput = 36;
+
+vector<float> compute(const Inputs &in) {
+    vector<float> out;
+    out.reserve(kCount * (kPerInput + 1));
+    for (size_t n = 0; n < kCount; ++n) {
+        Matrix4f product = in.a[n] * in.b[n];
+        Vector4f image = in.a[n] * in.v[n];
+        Matrix4f inverse = in.a[n].inverse();
+        const float *p = product;
+        const float *q = inverse;
+        out.insert(out.end(), p, p + 16);
+        for (int i = 0; i < 4; ++i) {
+            out.push_back(image[i]);
+        }
+        out.insert(out.end(), q, q + 16);
+    }
+    for (size_t n = 0; n < kCount; ++n) {
+        bool isSingular;
+        in.singular[n].inverse(&isSingular, kSingularEpsilon);
+        out.push_back(isSingular ? 1.f : 0.f);
+    }
+    return out;
+}
+
+#ifndef VECMATH_NO_SIMD
+// The mismatches of one kind of result at one level, and the largest
+// difference from the scalar result as a fraction of the tolerance
+struct Comparison {
+    const char *name;
+    size_t failures = 0;
+    double worst = 0;
+
+    explicit Comparison(const char *name) : name(name) {}
+
+    void check(const char *level, size_t n, int element, float got,
+               float want, double tolerance) {
+        double difference = fabs(double(got) - double(want));
+        if (tolerance > 0) {
+            worst = max(worst, difference / tolerance);
+        }
+        if (!(difference <= tolerance)) {
+            if (failures < 10) {
+                fprintf(stderr,
+                        "FAIL %s [%s]: input %zu element %d is %.9g, "
+                        "scalar %.9g, tolerance %.3g\n",
+                        name, level, n, element, got, want, tolerance);
+            }
+            ++failures;
+        }
+    }
+
+    // true if nothing failed
+    bool report(const char *level) const {
+        printf("%-32s [%s] %s, max difference %.3g of tolerance\n", name,
+               level, failures ? "FAILED" : "ok", worst);
+        if (failures) {
+            fprintf(stderr, "%s [%s]: %zu mismatches\n", name, level,
+                    failures);
+        }
+        return failures == 0;
+    }
+};
+
+// the largest row sum of |m|
+double normInf(const float *m) {
+    double norm = 0;
+    for (int i = 0; i < 4; ++i) {
+        double sum = 0;
+        for (int j = 0; j < 4; ++j) {
+            sum += fabs(m[4 * j + i]);
+        }
+        norm = max(norm, sum);
+    }
+    return norm;
+}
+
+// Compares got against the scalar results want; true if all are in
+// tolerance
+bool compare(const char *level, const Inputs &in, const vector<float> &got,
+             const vector<float> &want) {
+    Comparison products("Matrix4f * Matrix4f");
+    Comparison images("Matrix4f * Vector4f");
+    Comparison inverses("Matrix4f::inverse");
+    Comparison singulars("Matrix4f::inverse (singular)");
+
+    for (size_t n = 0; n < kCount; ++n) {
+        const float *g = &got[n * kPerInput];
+        const float *w = &want[n * kPerInput];
+        const Matrix4f &a = in.a[n];
+        const Matrix4f &b = in.b[n];
+
+        for (int i = 0; i < 4; ++i) {
+            for (int k = 0; k < 4; ++k) {
+                double terms = 0;
+                for (int j = 0; j < 4; ++j) {
+                    terms += fabs(a(i, j) * b(j, k));
+                }
+                products.check(level, n, 4 * k + i, g[4 * k + i],
+                               w[4 * k + i],
+                               kProductTolerance * FLT_EPSILON * terms);
+            }
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            double terms = 0;
+            for (int j = 0; j < 4; ++j) {
+                terms += fabs(a(i, j) * in.v[n][j]);
+            }
+            images.check(level, n, i, g[16 + i], w[16 + i],
+                         kProductTolerance * FLT_EPSILON * terms);
+        }
+
+        const float *gi = g + 20;
+        const float *wi = w + 20;
+        double largest = 0;
+        for (int e = 0; e < 16; ++e) {
+            largest = max(largest, double(fabs(wi[e])));
+        }
+        double condition = normInf(a) * normInf(wi);
+        for (int e = 0; e < 16; ++e) {
+            inverses.check(level, n, e, gi[e], wi[e],
+                           kInverseTolerance * FLT_EPSILON * condition *
+                               largest);
+        }
+    }
+
+    const float *g = &got[kCount * kPerInput];
+    const float *w = &want[kCount * kPerInput];
+    for (size_t n = 0; n < kCount; ++n) {
+        singulars.check(level, n, 0, g[n], w[n], 0);
+    }
+
+    bool ok = products.report(level);
+    ok &= images.report(level);
+    ok &= inverses.report(level);
+    ok &= singulars.report(level);
+    return ok;
+}
+#endif
+
+} // namespace
+
+int main() {
+    Inputs in = makeInputs();
+
+#ifdef VECMATH_NO_SIMD
+    vector<float> scalar = compute(in);
+    if (fwrite(scalar.data(), sizeof(float), scalar.size(), stdout) !=
+        scalar.size()) {
+        perror("check_scalar");
+        return 1;
+    }
+    return 0;
+#else
+    vector<float> scalar(kCount * (kPerInput + 1));
+    if (fread(scalar.data(), sizeof(float), scalar.size(), stdin) !=
+        scalar.size()) {
+        fprintf(stderr, "FAIL: no scalar results on stdin; run as "
+                        "./check_scalar | ./check_simd\n");
+        return 1;
+    }
+
+    // the scalar code itself must see the singular inputs
+    size_t flagged = count(scalar.end() - kCount, scalar.end(), 1.f);
+    if (flagged != kCount) {
+        fprintf(stderr, "FAIL: the scalar inverse missed %zu of %zu singular "
+                        "inputs\n", kCount - flagged, kCount);
+        return 1;
+    }
+
+    const SimdLevel defaultLevel = getSimdLevel();
+    bool ok = true;
+    for (int level = SIMD_SCALAR; level <= SIMD_AVX512; ++level) {
+        if (!setSimdLevel(SimdLevel(level))) {
+            continue;
+        }
+        ok &= compare(getSimdLevelName(SimdLevel(level)), in, compute(in),
+                      scalar);
+    }
+    setSimdLevel(defaultLevel);
+
+    if (!ok) {
+        fprintf(stderr, "FAIL: SIMD results differ from the scalar code\n");
+        return 1;
+    }
+    return 0;
+#endif
+}
@@ -1,12 +1,26 @@
 #ifndef VECMATH_H
 #define VECMATH_H
 
+#include "Affine3f.h"
+#include "BatchInterpolate.h"
+#include "BatchTransform.h"
+#include "BatchTrig.h"
+#include "Box3f.h"
+#include "Frustum.h"
+#include "Mat.h"
 #include "Matrix2f.h"
 #include "Matrix3f.h"
 #include "Matrix4f.h"
+#include "OctNormal.h"
 #include "Quat4f.h"
+#include "SimdDispatch.h"
+#include "Sphere3f.h"
+#include "TransformHierarchy.h"
+#include "Vec.h"
+#include "Vec3Array.h"
 #include "Vector2f.h"
 #include "Vector3f.h"
 #include "Vector4f.h"
+#include "VertexCache.h"
 
 #endif // VECMATH_H
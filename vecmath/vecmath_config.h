@@ -0,0 +1,55 @@
+#ifndef VECMATH_CONFIG_H
+#define VECMATH_CONFIG_H
+
+// Build configuration shared by every vecmath header.
+//
+// Defining VECMATH_HEADER_ONLY (e.g. -DVECMATH_HEADER_ONLY) before including
+// any vecmath header compiles the whole library inline into the including
+// translation unit, so that accessors and operators can be inlined into hot
+// loops without LTO.  Programs built this way must not also link libvecmath.
+// The static and shared libraries are always built with it undefined.
+//
+// The .cpp files keep their helpers in namespace vecmath_detail as inline
+// functions and constexpr constants, not in an anonymous namespace: in a
+// header-only program every translation unit defines the VECMATH_INLINE
+// functions, and each definition must call the same helpers.
+#ifdef VECMATH_HEADER_ONLY
+#define VECMATH_INLINE inline
+#else
+#define VECMATH_INLINE
+#endif
+
+// VECMATH_CHECK(condition) aborts with a message when condition is false,
+// but only if VECMATH_DEBUG is defined; otherwise condition is not even
+// evaluated.  It guards preconditions whose test costs more than the
+// operation, such as isOrthonormal() before an inverse that merely
+// transposes, and, unlike assert, stays out of builds that leave NDEBUG
+// unset.  For the library's own functions it is the library's build that
+// counts: `make VECMATH_DEBUG=1`.
+#ifdef VECMATH_DEBUG
+#include <cstdio>
+#include <cstdlib>
+#define VECMATH_CHECK(condition)                                              \
+    ((condition) ? (void)0                                                    \
+                 : (std::fprintf(stderr, "%s:%d: vecmath check failed: %s\n", \
+                                 __FILE__, __LINE__, #condition),             \
+                    std::abort()))
+#else
+#define VECMATH_CHECK(condition) ((void)0)
+#endif
+
+// SIMD kernels are selected at build time from the target instruction set:
+// SSE2 is used on every x86-64 build, AVX (and FMA) kernels when compiled
+// with e.g. -mavx2 -mfma.  Define VECMATH_NO_SIMD to force the portable
+// scalar code.
+#if !defined(VECMATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define VECMATH_SSE
+#if defined(__AVX__)
+#define VECMATH_AVX
+#endif
+#if defined(__FMA__)
+#define VECMATH_FMA
+#endif
+#endif
+
+#endif // VECMATH_CONFIG_H
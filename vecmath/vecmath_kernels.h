@@ -0,0 +1,58 @@
+#ifndef VECMATH_KERNELS_H
+#define VECMATH_KERNELS_H
+
+// The kernels chosen at run time (see SimdDispatch.h).  Internal: not
+// included by vecmath.h, and empty unless VECMATH_SSE is defined.
+
+#include "vecmath_config.h"
+
+#include "SimdDispatch.h"
+
+#include <cstddef>
+
+#ifdef VECMATH_SSE
+// One instruction set's kernels.  They take plain floats: packed x, y, z
+// triples (AoS) or separate x, y and z arrays (SoA), and column-major 4x4
+// matrices.  Outputs may be the same array as an input, but must not
+// otherwise overlap one.
+struct SimdKernels {
+    SimdLevel level;
+
+    // out[i] = R * (in[i], 1), R the top three rows of an affine transform,
+    // row-major in 12 floats
+    void (*transformAoS)(const float *rows, const float *in, float *out,
+                         size_t n);
+    void (*transformSoA)(const float *rows, const float *x, const float *y,
+                         const float *z, float *outX, float *outY,
+                         float *outZ, size_t n);
+
+    // out[i] = in[i] / |in[i]|, or, if fast, in[i] times a refined
+    // reciprocal square root estimate (see Vector3f::normalizedFast)
+    void (*normalizeAoS)(const float *in, float *out, size_t n, bool fast);
+    void (*normalizeSoA)(const float *x, const float *y, const float *z,
+                         float *outX, float *outY, float *outZ, size_t n,
+                         bool fast);
+
+    // out = a * b
+    void (*multiply4x4)(const float *a, const float *b, float *out);
+    // out = m^-1, by Cramer's rule; returns the determinant, and out is
+    // meaningless when that is (close to) 0
+    float (*inverse4x4)(const float *m, float *out);
+};
+
+// SimdKernels.cpp compiled with the library's own flags, and, when built for
+// dispatch, again with -mavx2 -mfma and -mavx512f -mfma
+const SimdKernels &simdKernelsBase();
+const SimdKernels &simdKernelsAVX2();
+const SimdKernels &simdKernelsAVX512();
+
+// the kernels of getSimdLevel()
+const SimdKernels &simdKernels();
+#endif
+
+#ifdef VECMATH_HEADER_ONLY
+#include "SimdDispatch.cpp"
+#include "SimdKernels.cpp"
+#endif
+
+#endif // VECMATH_KERNELS_H
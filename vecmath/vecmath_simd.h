@@ -0,0 +1,161 @@
+#ifndef VECMATH_SIMD_H
+#define VECMATH_SIMD_H
+
+// SSE helpers shared by the vecmath kernels.  Internal: not included by
+// vecmath.h, and empty unless VECMATH_SSE is defined.
+
+#include "vecmath_config.h"
+
+#ifdef VECMATH_SSE
+#include <immintrin.h>
+
+// a * b + c, fused when FMA is available
+inline __m128 simdMadd(__m128 a, __m128 b, __m128 c) {
+#ifdef VECMATH_FMA
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+// 1 / sqrt(x): the ~12-bit rsqrtps estimate y refined by one Newton-Raphson
+// step, y * (1.5 - 0.5 * x * y * y).  Relative error is a few ulp (see
+// Vector3f::normalizedFast); 0 gives NaN rather than infinity.
+inline __m128 simdRsqrt(__m128 x) {
+    __m128 y = _mm_rsqrt_ps(x);
+    __m128 halfXYY = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x),
+                                _mm_mul_ps(y, y));
+    return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), halfXYY));
+}
+
+// the smallest and largest of the four lanes of v
+inline float simdHMin(__m128 v) {
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+inline float simdHMax(__m128 v) {
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+// acos(x) for x in [-1, 1] (Abramowitz & Stegun 4.4.46): sqrt(1 - |x|) times
+// a degree 7 polynomial, absolute error about 1e-7 radians.
+inline __m128 simdAcos(__m128 x) {
+    const __m128 signMask = _mm_set1_ps(-0.f);
+    __m128 a = _mm_andnot_ps(signMask, x);
+
+    __m128 p = _mm_set1_ps(-0.0012624911f);
+    p = simdMadd(p, a, _mm_set1_ps(0.0066700901f));
+    p = simdMadd(p, a, _mm_set1_ps(-0.0170881256f));
+    p = simdMadd(p, a, _mm_set1_ps(0.0308918810f));
+    p = simdMadd(p, a, _mm_set1_ps(-0.0501743046f));
+    p = simdMadd(p, a, _mm_set1_ps(0.0889789874f));
+    p = simdMadd(p, a, _mm_set1_ps(-0.2145988016f));
+    p = simdMadd(p, a, _mm_set1_ps(1.5707963050f));
+    p = _mm_mul_ps(p, _mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.f), a)));
+
+    // acos(-x) = pi - acos(x)
+    __m128 negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+    __m128 reflected = _mm_sub_ps(_mm_set1_ps(3.14159265f), p);
+    return _mm_or_ps(_mm_and_ps(negative, reflected),
+                     _mm_andnot_ps(negative, p));
+}
+
+// sin(x): reduced to r = x - k * pi in [-pi/2, pi/2] (pi split in three for
+// the subtraction) and a degree 11 Taylor polynomial, so the absolute error
+// is about 1e-7 for |x| up to a few thousand.
+inline __m128 simdSin(__m128 x) {
+    __m128i k = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.318309886f)));
+    __m128 kf = _mm_cvtepi32_ps(k);
+
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(kf, _mm_set1_ps(3.140625f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(9.67502593994140625e-4f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(1.509957990978376e-7f)));
+
+    __m128 r2 = _mm_mul_ps(r, r);
+    __m128 p = _mm_set1_ps(-2.5052108e-8f);
+    p = simdMadd(p, r2, _mm_set1_ps(2.7557319e-6f));
+    p = simdMadd(p, r2, _mm_set1_ps(-1.9841270e-4f));
+    p = simdMadd(p, r2, _mm_set1_ps(8.3333333e-3f));
+    p = simdMadd(p, r2, _mm_set1_ps(-1.6666667e-1f));
+    p = simdMadd(_mm_mul_ps(p, r2), r, r);
+
+    // sin(r + k * pi) = (-1)^k sin(r)
+    __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(k, 31));
+    return _mm_xor_ps(p, sign);
+}
+
+// sin(x) and cos(x) together: reduced to r = x - q * pi/2 in [-pi/4, pi/4]
+// (pi/2 split in three as in simdSin) and degree 9 and 10 Taylor polynomials
+// in r, then rotated into quadrant q.  Absolute error about 1e-7 for |x| up
+// to a few thousand.
+inline void simdSinCos(__m128 x, __m128 &s, __m128 &c) {
+    __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772f)));
+    __m128 qf = _mm_cvtepi32_ps(q);
+
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(1.5703125f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(4.837512969970703125e-4f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(7.549789948768648e-8f)));
+
+    __m128 r2 = _mm_mul_ps(r, r);
+    __m128 ps = _mm_set1_ps(2.7557319e-6f);
+    ps = simdMadd(ps, r2, _mm_set1_ps(-1.9841270e-4f));
+    ps = simdMadd(ps, r2, _mm_set1_ps(8.3333333e-3f));
+    ps = simdMadd(ps, r2, _mm_set1_ps(-1.6666667e-1f));
+    ps = simdMadd(_mm_mul_ps(ps, r2), r, r);
+
+    __m128 pc = _mm_set1_ps(-2.7557319e-7f);
+    pc = simdMadd(pc, r2, _mm_set1_ps(2.4801587e-5f));
+    pc = simdMadd(pc, r2, _mm_set1_ps(-1.3888889e-3f));
+    pc = simdMadd(pc, r2, _mm_set1_ps(4.1666667e-2f));
+    pc = simdMadd(pc, r2, _mm_set1_ps(-0.5f));
+    pc = simdMadd(pc, r2, _mm_set1_ps(1.f));
+
+    // odd quadrants swap sin and cos; sin is negated in quadrants 2 and 3,
+    // cos in 1 and 2
+    __m128 swap = _mm_castsi128_ps(
+        _mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)),
+                        _mm_set1_epi32(1)));
+    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(q, 1), 31));
+    __m128 cosSign = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_srli_epi32(_mm_add_epi32(q, _mm_set1_epi32(1)), 1),
+                       31));
+    s = _mm_or_ps(_mm_and_ps(swap, pc), _mm_andnot_ps(swap, ps));
+    c = _mm_or_ps(_mm_and_ps(swap, ps), _mm_andnot_ps(swap, pc));
+    s = _mm_xor_ps(s, sinSign);
+    c = _mm_xor_ps(c, cosSign);
+}
+
+// Loads four packed Vector3f (12 floats: x0 y0 z0 x1 | y1 z1 x2 y2 |
+// z2 x3 y3 z3) as x0..x3, y0..y3 and z0..z3.
+inline void simdLoadVector3fx4(const float *src, __m128 &x, __m128 &y,
+                               __m128 &z) {
+    __m128 a = _mm_loadu_ps(src);
+    __m128 b = _mm_loadu_ps(src + 4);
+    __m128 c = _mm_loadu_ps(src + 8);
+
+    __m128 t0 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    __m128 t1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    x = _mm_shuffle_ps(a, t0, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(t1, t0, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm_shuffle_ps(t1, c, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+// The inverse of simdLoadVector3fx4.
+inline void simdStoreVector3fx4(float *dst, __m128 x, __m128 y, __m128 z) {
+    __m128 xy0 = _mm_unpacklo_ps(x, y);
+    __m128 xy1 = _mm_unpackhi_ps(x, y);
+    __m128 q = _mm_shuffle_ps(z, xy0, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 r = _mm_shuffle_ps(xy0, z, _MM_SHUFFLE(1, 1, 3, 3));
+    __m128 t = _mm_shuffle_ps(z, xy1, _MM_SHUFFLE(3, 2, 3, 2));
+
+    _mm_storeu_ps(dst, _mm_shuffle_ps(xy0, q, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(dst + 4, _mm_shuffle_ps(r, xy1, _MM_SHUFFLE(1, 0, 2, 0)));
+    _mm_storeu_ps(dst + 8, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 3, 2, 0)));
+}
+#endif
+
+#endif // VECMATH_SIMD_H
@@ -0,0 +1,378 @@
+#include "mesh.h"
+#include "meshcache.h"
+#include "objload.h"
+#include "simplify.h"
+
+#include <vecmath.h>
+
+#include <fcntl.h>
+#include <malloc.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Runs fn() until at least minSeconds have passed and reports the best
+// time per run, and per item (a line of the file, say), over all
+// repetitions.
+template <typename F>
+void run(const char *name, size_t items, const char *unit, F fn,
+         double minSeconds = 0.5) {
+    using clock = chrono::steady_clock;
+
+    double best = 1e30;
+    auto start = clock::now();
+
+    do {
+        auto t0 = clock::now();
+        fn();
+        auto t1 = clock::now();
+        best = min(best, chrono::duration<double, nano>(t1 - t0).count());
+    } while (chrono::duration<double>(clock::now() - start).count() <
+             minSeconds);
+
+    printf("%-34s %10zu %-9s %9.3f ms %7.2f ns/item\n", name, items, unit,
+           best / 1e6, best / items);
+}
+
+// a0's mesh as it was: a heap-allocated vector of six OBJ indices per face
+struct LegacyObj {
+    vector<Vector3f> vecv;
+    vector<Vector3f> vecn;
+    vector<vector<unsigned>> vecf;
+};
+
+// a0's loadInput as it was, kept to compare with objload
+void loadIstream(istream &stream, LegacyObj &obj) {
+    string line;
+
+    while (getline(stream, line)) {
+        if (line == "")
+            continue;
+
+        istringstream words(line);
+
+        string type;
+        words >> type;
+
+        if (type == "v") {
+            float x, y, z;
+            words >> x >> y >> z;
+            obj.vecv.push_back(Vector3f(x, y, z));
+        } else if (type == "vn") {
+            float x, y, z;
+            words >> x >> y >> z;
+            obj.vecn.push_back(Vector3f(x, y, z));
+        } else if (type == "f") {
+            string abc, def, ghi;
+            words >> abc >> def >> ghi;
+
+            unsigned int a, b, c;
+            sscanf(abc.c_str(), "%u/%u/%u", &a, &b, &c);
+
+            unsigned int d, e, f;
+            sscanf(def.c_str(), "%u/%u/%u", &d, &e, &f);
+
+            unsigned int g, h, i;
+            sscanf(ghi.c_str(), "%u/%u/%u", &g, &h, &i);
+
+            obj.vecf.push_back({a, c, d, f, g, i});
+        }
+    }
+}
+
+bool sameVectors(const vector<Vector3f> &lhs, const vector<Vector3f> &rhs) {
+    return lhs.size() == rhs.size() &&
+           memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(Vector3f)) == 0;
+}
+
+bool same(const ObjData &lhs, const ObjData &rhs) {
+    return sameVectors(lhs.vecv, rhs.vecv) && sameVectors(lhs.vecn, rhs.vecn) &&
+           lhs.vecf == rhs.vecf;
+}
+
+bool same(const LegacyObj &lhs, const ObjData &rhs) {
+    vector<uint32_t> faces;
+    for (const auto &face : lhs.vecf) {
+        faces.insert(faces.end(), face.begin(), face.end());
+    }
+    return sameVectors(lhs.vecv, rhs.vecv) && sameVectors(lhs.vecn, rhs.vecn) &&
+           faces == rhs.vecf;
+}
+
+// The heap a LegacyObj takes, counting each face's allocation as malloc
+// rounds it, plus malloc's own word
+size_t memoryBytes(const LegacyObj &obj) {
+    size_t bytes = (obj.vecv.capacity() + obj.vecn.capacity()) *
+                       sizeof(Vector3f) +
+                   obj.vecf.capacity() * sizeof(vector<unsigned>);
+    for (const auto &face : obj.vecf) {
+        bytes += malloc_usable_size(const_cast<unsigned *>(face.data())) +
+                 sizeof(size_t);
+    }
+    return bytes;
+}
+
+// Times weldMesh, and the loop that feeds a mesh to GL per vertex, as
+// drawObject did, against the same for the welded mesh; here the GL calls
+// just copy what they'd be given.  a0 draws the welded mesh with one
+// glDrawElements instead, which this can't time.  Then reports the vertex
+// cache statistics of optimizeMesh's order and times it.
+void runMesh(const string &name, const LegacyObj &legacy, const ObjData &obj) {
+    IndexedMesh mesh = weldMesh(obj);
+    size_t triangles = mesh.indices.size() / 3;
+    printf("%-34s %zu vertices for %zu positions, %.0f KiB -> %.0f KiB\n",
+           (name + " weldMesh").c_str(), mesh.positions.size(),
+           obj.vecv.size(), memoryBytes(legacy) / 1024.,
+           mesh.memoryBytes() / 1024.);
+
+    run((name + " weldMesh").c_str(), triangles, "triangles",
+        [&] { return weldMesh(obj).indices.size(); });
+
+    // what immediate mode copies into GL's command stream
+    vector<Vector3f> stream(6 * triangles);
+    run((name + " draw vector<vector>").c_str(), triangles, "triangles",
+        [&] {
+            Vector3f *out = stream.data();
+            for (const auto &face : legacy.vecf) {
+                for (int corner = 0; corner < 3; ++corner) {
+                    *out++ = legacy.vecn[face[2 * corner + 1] - 1];
+                    *out++ = legacy.vecv[face[2 * corner] - 1];
+                }
+            }
+        });
+    auto drawIndexed = [&](const IndexedMesh &drawn) {
+        Vector3f *out = stream.data();
+        for (uint32_t v : drawn.indices) {
+            *out++ = drawn.normals[v];
+            *out++ = drawn.positions[v];
+        }
+    };
+    run((name + " draw indexed").c_str(), triangles, "triangles",
+        [&] { drawIndexed(mesh); });
+
+    // the vertex cache order, and what a GPU's FIFO cache makes of it
+    IndexedMesh optimized = mesh;
+    optimizeMesh(optimized);
+    for (unsigned cacheSize : {16u, 32u}) {
+        VertexCacheStats before = analyzeMesh(mesh.view(), cacheSize);
+        VertexCacheStats after = analyzeMesh(optimized.view(), cacheSize);
+        char label[64];
+        snprintf(label, sizeof(label), "%s FIFO %u", name.c_str(), cacheSize);
+        printf("%-34s ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", label,
+               before.acmr, after.acmr, before.atvr, after.atvr);
+    }
+    run((name + " optimizeMesh").c_str(), triangles, "triangles", [&] {
+        IndexedMesh copy = mesh;
+        optimizeMesh(copy);
+    });
+    run((name + " draw indexed (optimized)").c_str(), triangles, "triangles",
+        [&] { drawIndexed(optimized); });
+}
+
+// Times simplifying mesh to a0's levels of detail, and reports each level's
+// triangles, error and vertex cache statistics
+void runLods(const string &name, const IndexedMesh &mesh) {
+    size_t triangles = mesh.indices.size() / 3;
+    vector<size_t> targets = {triangles / 2, triangles / 4, triangles / 10};
+    vector<MeshLod> lods = simplifyMesh(mesh.view(), targets);
+    for (size_t level = 0; level < lods.size(); ++level) {
+        const MeshLod &lod = lods[level];
+        VertexCacheStats stats = analyzeVertexCache(
+            lod.indices.data(), lod.indices.size(), mesh.positions.size());
+        char label[64];
+        snprintf(label, sizeof(label), "%s level %zu", name.c_str(),
+                 level + 1);
+        printf("%-34s %zu triangles, error %.5f, ACMR %.3f\n", label,
+               lod.indices.size() / 3, lod.error, stats.acmr);
+    }
+    run((name + " simplifyMesh").c_str(), triangles, "triangles",
+        [&] { return simplifyMesh(mesh.view(), targets).size(); });
+}
+
+// Times parseObj on text split over 1, 2, 4 and 8 threads, after checking
+// each split gives the serial result
+bool runThreads(const string &name, const string &text, size_t lines) {
+    const char *begin = text.data();
+    const char *end = begin + text.size();
+
+    ObjData serial;
+    parseObj(begin, end, serial);
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        ObjData split;
+        parseObj(begin, end, split, threads);
+        if (!same(serial, split)) {
+            fprintf(stderr, "%s: %u threads disagree with one\n",
+                    name.c_str(), threads);
+            return false;
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s parseObj (%u threads)",
+                 name.c_str(), threads);
+        run(label, lines, "lines", [&] {
+            ObjData obj;
+            parseObj(begin, end, obj, threads);
+        });
+    }
+    return true;
+}
+
+// Times writing the mesh cache of text and mapping it back, on a copy of
+// text in /tmp, after checking the mapped mesh is the welded one
+bool runCache(const string &name, const string &text, size_t lines) {
+    string sourcePath = "/tmp/a0bench-" + name;
+    string cachePath = sourcePath + ".a0mesh";
+    ofstream(sourcePath, ios::binary) << text;
+    int fd = open(sourcePath.c_str(), O_RDONLY);
+
+    ObjData obj;
+    parseObj(text.data(), text.data() + text.size(), obj);
+    IndexedMesh welded = weldMesh(obj);
+    MeshView mesh = welded.view();
+    vector<MeshLod> simplified =
+        simplifyMesh(mesh, {mesh.indexCount / 6, mesh.indexCount / 12});
+    vector<MeshLodView> lods;
+    for (const MeshLod &lod : simplified) {
+        lods.push_back(lod.view());
+    }
+
+    bool ok = writeMeshCache(cachePath.c_str(), mesh, lods, fd, text.data(),
+                             text.size());
+    {
+        MeshCache cache(cachePath.c_str(), fd);
+        const MeshView &view = cache.view();
+        size_t vertexBytes = mesh.vertexCount * sizeof(Vector3f);
+        ok = ok && cache.ok() && view.vertexCount == mesh.vertexCount &&
+             view.indexCount == mesh.indexCount &&
+             memcmp(view.positions, mesh.positions, vertexBytes) == 0 &&
+             memcmp(view.normals, mesh.normals, vertexBytes) == 0 &&
+             memcmp(view.indices, mesh.indices,
+                    mesh.indexCount * sizeof(uint32_t)) == 0 &&
+             cache.lods().size() == lods.size();
+        for (size_t level = 0; ok && level < lods.size(); ++level) {
+            const MeshLodView &lod = cache.lods()[level];
+            ok = lod.indexCount == lods[level].indexCount &&
+                 lod.error == lods[level].error &&
+                 memcmp(lod.indices, lods[level].indices,
+                        lod.indexCount * sizeof(uint32_t)) == 0;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: the cache doesn't hold the parsed mesh\n",
+                name.c_str());
+    } else {
+        run((name + " writeMeshCache").c_str(), lines, "lines", [&] {
+            writeMeshCache(cachePath.c_str(), mesh, lods, fd, text.data(),
+                           text.size());
+        });
+        run((name + " MeshCache").c_str(), lines, "lines", [&] {
+            MeshCache cache(cachePath.c_str(), fd);
+            return cache.ok();
+        });
+
+        // a touched source: the same bytes, checked by hash
+        struct timespec times[2] = {{0, UTIME_OMIT}, {1, 0}};
+        futimens(fd, times);
+        run((name + " MeshCache (hashed)").c_str(), lines, "lines", [&] {
+            MeshCache cache(cachePath.c_str(), fd);
+            return cache.ok();
+        });
+    }
+
+    close(fd);
+    unlink(cachePath.c_str());
+    unlink(sourcePath.c_str());
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        paths = {"../sphere.obj", "../torus.obj", "../garg.obj"};
+    }
+
+    printf("%u hardware threads\n", thread::hardware_concurrency());
+
+    string largest;
+    for (auto &path : paths) {
+        ifstream in(path);
+        stringstream text;
+        text << in.rdbuf();
+        string contents = text.str();
+        size_t lines = count(contents.begin(), contents.end(), '\n');
+        if (contents.empty()) {
+            fprintf(stderr, "can't read %s\n", path.c_str());
+            return 1;
+        }
+        if (contents.size() > largest.size()) {
+            largest = contents;
+        }
+
+        LegacyObj reference;
+        istringstream referenceStream(contents);
+        loadIstream(referenceStream, reference);
+        ObjData parsed;
+        parseObj(contents.data(), contents.data() + contents.size(), parsed);
+        if (!same(reference, parsed)) {
+            fprintf(stderr, "%s: objload disagrees with istream\n",
+                    path.c_str());
+            return 1;
+        }
+
+        string name = path.substr(path.rfind('/') + 1);
+        run((name + " istream").c_str(), lines, "lines", [&] {
+            LegacyObj obj;
+            istringstream stream(contents);
+            loadIstream(stream, obj);
+        });
+        run((name + " parseObj (in memory)").c_str(), lines, "lines", [&] {
+            ObjData obj;
+            parseObj(contents.data(), contents.data() + contents.size(), obj);
+        });
+        run((name + " loadObj (mmap)").c_str(), lines, "lines", [&] {
+            ObjData obj;
+            int fd = open(path.c_str(), O_RDONLY);
+            loadObj(fd, obj);
+            close(fd);
+        });
+        if (!runThreads(name, contents, lines) ||
+            !runCache(name, contents, lines)) {
+            return 1;
+        }
+        runMesh(name, reference, parsed);
+        IndexedMesh mesh = weldMesh(parsed);
+        optimizeMesh(mesh);
+        runLods(name, mesh);
+    }
+
+    // a scan-sized input: the largest file sixteen times over (its face
+    // indices all point into the first copy)
+    string large;
+    for (int i = 0; i < 16; ++i) {
+        large += largest;
+    }
+    size_t lines = count(large.begin(), large.end(), '\n');
+    if (!runThreads("16 x largest", large, lines)) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,25 +1,64 @@
+#include "mesh.h"
+#include "meshcache.h"
+#include "objload.h"
+#include "simplify.h"
+
 #include <GL/glut.h>
+#include <unistd.h>
 #include <vecmath.h>
 
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <sstream>
+#include <string>
 #include <vector>
 
 using namespace std;
 
 // Globals
 
-// This is the list of points (3D vectors)
-vector<Vector3f> vecv;
+// This is the mesh: the list of points (3D vectors) with their normals
+// (also 3D vectors), welded into one vertex per (position, normal) pair, and
+// the list of triangles, three vertex indices each, in vertex cache order
+// (see optimizeMesh).  Its arrays are either mapped from the mesh cache or
+// those of the welded OBJ below.
+MeshView mesh;
+
+unique_ptr<MeshCache> cache;
+IndexedMesh welded;
+
+// The levels of detail drawObject picks from, finest first: the mesh itself,
+// then coarser triangles over its vertices, from the mesh cache or those
+// simplified below
+vector<MeshLodView> levels;
+vector<MeshLod> simplified;
+
+// The levels simplified at load time, as fractions of the mesh's triangles
+const float lodFractions[] = {0.5f, 0.25f, 0.1f};
 
-// This is the list of normals (also 3D vectors)
-vector<Vector3f> vecn;
+// The most pixels a level's error may cover on screen for it to be drawn
+const float maxErrorPixels = 0.5f;
 
-// This is the list of faces (indices into vecv and vecn)
-vector<vector<unsigned>> vecf;
+// The bounds of the mesh, and the side of the square viewport in pixels, for
+// the size of a level's error on screen
+Sphere3f bounds;
+int viewportSize = 360;
+size_t drawnLevel = 0;
+
+// Threads to parse the input on (`-j N`); 0 picks as many as pay off
+unsigned loadThreads = 0;
+
+// Whether to map and write the mesh cache (off with `--no-cache`)
+bool useCache = true;
+
+// `--dump-lods PREFIX` writes level k to PREFIXk.obj and exits
+const char *dumpPrefix = nullptr;
 
 // You will need more global variables to implement color and position changes
 int color = 0;
@@ -32,24 +71,45 @@ inline void glVertex(const Vector3f &a) { glVertex3fv(a); }
 
 inline void glNormal(const Vector3f &a) { glNormal3fv(a); }
 
-void drawObject() {
-    for (const auto &face : vecf) {
-        auto a = face[0];
-        auto c = face[1];
-        auto d = face[2];
-        auto f = face[3];
-        auto g = face[4];
-        auto i = face[5];
-
-        glBegin(GL_TRIANGLES);
-        glNormal(vecn[c - 1]);
-        glVertex(vecv[a - 1]);
-        glNormal(vecn[f - 1]);
-        glVertex(vecv[d - 1]);
-        glNormal(vecn[i - 1]);
-        glVertex(vecv[g - 1]);
-        glEnd();
+// The coarsest level whose error, at the mesh's nearest point to the
+// camera, covers at most maxErrorPixels on screen with the mesh turned by
+// degrees
+size_t selectLevel(float degrees) {
+    // the camera is at (0, 0, 5), and the mesh turns about the y axis
+    float radians = degrees * float(M_PI) / 180;
+    Vector3f center = Matrix3f::rotateY(radians) * bounds.getCenter();
+    float distance = (Vector3f(0, 0, 5) - center).abs() - bounds.getRadius();
+    // gluPerspective(50, 1, 1, 100): the near plane is at 1, and the
+    // viewport spans 2 tan(25 degrees) at distance 1
+    distance = max(distance, 1.f);
+    float pixelsPerUnit =
+        viewportSize / (2 * distance * tan(25 * float(M_PI) / 180));
+
+    size_t level = levels.size() - 1;
+    while (level > 0 && levels[level].error * pixelsPerUnit > maxErrorPixels) {
+        --level;
+    }
+    return level;
+}
+
+void drawObject(size_t level) {
+    const MeshLodView &lod = levels[level];
+    if (level != drawnLevel) {
+        cerr << "Drawing level of detail " << level << " ("
+             << lod.indexCount / 3 << " triangles)." << endl;
+        drawnLevel = level;
     }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, mesh.positions);
+    glNormalPointer(GL_FLOAT, 0, mesh.normals);
+
+    glDrawElements(GL_TRIANGLES, lod.indexCount, GL_UNSIGNED_INT,
+                   lod.indices);
+
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 bool is_rotating = false;
@@ -175,7 +235,7 @@ void drawScene() {
     glPushMatrix();
     glRotatef(angle, 0, 1, 0);
 
-    drawObject();
+    drawObject(selectLevel(angle));
 
     glPopMatrix();
 
@@ -194,6 +254,7 @@ void initRendering() {
 // w, h - width and height of the window in pixels.
 void reshapeFunc(int w, int h) {
     // Always use the largest square viewport possible
+    viewportSize = min(w, h);
     if (w > h) {
         glViewport((w - h) / 2, 0, h, h);
     } else {
@@ -207,48 +268,132 @@ void reshapeFunc(int w, int h) {
     gluPerspective(50, 1, 1, 100);
 }
 
-void loadInput(istream &stream) {
-    string line;
-
-    while (getline(stream, line)) {
-        if (line == "")
-            continue;
-
-        istringstream words(line);
-
-        string type;
-        words >> type;
-
-        if (type == "v") {
-            float x, y, z;
-            words >> x >> y >> z;
-            vecv.push_back(Vector3f(x, y, z));
-        } else if (type == "vn") {
-            float x, y, z;
-            words >> x >> y >> z;
-            vecn.push_back(Vector3f(x, y, z));
-        } else if (type == "f") {
-            string abc, def, ghi;
-            words >> abc >> def >> ghi;
+// Sets mesh and its levels of detail, lods
+void setMesh(const MeshView &view, const vector<MeshLodView> &lods) {
+    mesh = view;
+    MeshLodView full;
+    full.indices = mesh.indices;
+    full.indexCount = mesh.indexCount;
+    levels.assign(1, full);
+    levels.insert(levels.end(), lods.begin(), lods.end());
+    bounds = Sphere3f::fromPoints(mesh.positions, mesh.vertexCount);
+}
 
-            unsigned int a, b, c;
-            sscanf(abc.c_str(), "%u/%u/%u", &a, &b, &c);
+// Loads the mesh from the OBJ file open on fd: from its cache if that is
+// up to date, and otherwise by parsing it, simplifying it and writing the
+// cache
+void loadInput(int fd) {
+    string cachePath = useCache ? meshCachePath(fd) : "";
+    if (!cachePath.empty()) {
+        cache.reset(new MeshCache(cachePath.c_str(), fd));
+        if (cache->ok()) {
+            if (cache->sourceTouched() &&
+                !touchMeshCache(cachePath.c_str(), fd)) {
+                cerr << "Could not update the mesh cache " << cachePath << "."
+                     << endl;
+            }
+            setMesh(cache->view(), cache->lods());
+            return;
+        }
+        cache.reset();
+    }
 
-            unsigned int d, e, f;
-            sscanf(def.c_str(), "%u/%u/%u", &d, &e, &f);
+    FileContents file(fd);
+    if (!file.ok()) {
+        cerr << "Could not read the OBJ input." << endl;
+        exit(1);
+    }
+    ObjData obj;
+    parseObj(file.data(), file.data() + file.size(), obj, loadThreads);
+    welded = weldMesh(obj);
+
+    // in the order the GPU's vertex cache likes best, which the mesh cache
+    // keeps
+    VertexCacheStats before = analyzeMesh(welded.view());
+    optimizeMesh(welded);
+    VertexCacheStats after = analyzeMesh(welded.view());
+    cerr << "vertex cache: ACMR " << before.acmr << " -> " << after.acmr
+         << ", ATVR " << before.atvr << " -> " << after.atvr << endl;
+
+    // OBJ normals need not be unit length, but the lighting assumes they are
+    normalizeNormals(welded);
+
+    // at least a triangle each: selectLevel would otherwise make a small
+    // mesh vanish at a distance
+    vector<size_t> targets;
+    for (float fraction : lodFractions) {
+        targets.push_back(
+            max(size_t(fraction * welded.indices.size() / 3), size_t(1)));
+    }
+    simplified = simplifyMesh(welded.view(), targets);
+
+    // a level no smaller than the one before it would only be drawn in its
+    // place
+    size_t previous = welded.indices.size();
+    vector<MeshLod> kept;
+    for (MeshLod &lod : simplified) {
+        if (!lod.indices.empty() && lod.indices.size() < previous) {
+            previous = lod.indices.size();
+            kept.push_back(move(lod));
+        }
+    }
+    simplified.swap(kept);
+
+    vector<MeshLodView> lods;
+    for (const MeshLod &lod : simplified) {
+        lods.push_back(lod.view());
+        cerr << "level of detail " << lods.size() << ": "
+             << lod.indices.size() / 3 << " triangles, error " << lod.error
+             << endl;
+    }
+    setMesh(welded.view(), lods);
 
-            unsigned int g, h, i;
-            sscanf(ghi.c_str(), "%u/%u/%u", &g, &h, &i);
+    if (!cachePath.empty() &&
+        !writeMeshCache(cachePath.c_str(), mesh, lods, fd, file.data(),
+                        file.size())) {
+        cerr << "Could not write the mesh cache " << cachePath << "." << endl;
+    }
+}
 
-            vecf.push_back({a, c, d, f, g, i});
+// Takes a0's own options out of argv, leaving GLUT's
+void parseOptions(int &argc, char **argv) {
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            loadThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            useCache = false;
+        } else if (strcmp(argv[i], "--dump-lods") == 0 && i + 1 < argc) {
+            dumpPrefix = argv[++i];
+        } else {
+            argv[kept++] = argv[i];
         }
     }
+    argc = kept;
+    argv[argc] = nullptr;
 }
 
 // Main routine.
 // Set up OpenGL, define the callbacks and start the main loop
 int main(int argc, char **argv) {
-    loadInput(cin);
+    parseOptions(argc, argv);
+    loadInput(STDIN_FILENO);
+
+    if (dumpPrefix) {
+        for (size_t level = 0; level < levels.size(); ++level) {
+            string path = dumpPrefix + to_string(level) + ".obj";
+            ofstream out(path);
+            MeshView view = mesh;
+            view.indices = levels[level].indices;
+            view.indexCount = levels[level].indexCount;
+            writeObj(out, view);
+            if (!out) {
+                cerr << "Could not write " << path << "." << endl;
+                exit(1);
+            }
+        }
+        exit(0);
+    }
 
     glutInit(&argc, argv);
 
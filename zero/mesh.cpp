@@ -0,0 +1,236 @@
+#include "mesh.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace {
+
+// The vertex for each (position, normal) index pair: open addressing with
+// linear probing over a power-of-two table at most half full, which beats
+// std::unordered_map's node per entry at the millions of corners of a scan
+class CornerMap {
+  public:
+    explicit CornerMap(size_t expected) { rehash(2 * expected); }
+
+    // The vertex of key, or, if it has none yet, next, which becomes its;
+    // inserted tells which
+    uint32_t find(uint64_t key, uint32_t next, bool &inserted) {
+        size_t slot = slotOf(key);
+        while (m_keys[slot] != kEmpty) {
+            if (m_keys[slot] == key) {
+                inserted = false;
+                return m_values[slot];
+            }
+            slot = (slot + 1) & m_mask;
+        }
+        m_keys[slot] = key;
+        m_values[slot] = next;
+        inserted = true;
+        if (++m_size > m_keys.size() / 2) {
+            rehash(2 * m_keys.size());
+        }
+        return next;
+    }
+
+  private:
+    // no pair of 1-based indices packs to this
+    static constexpr uint64_t kEmpty = 0;
+
+    // a multiplicative hash: the high bits mix every bit of the key
+    size_t slotOf(uint64_t key) const {
+        return (key * 0x9e3779b97f4a7c15) >> 24 & m_mask;
+    }
+
+    // moves the entries to a table of at least size slots
+    void rehash(size_t size) {
+        size_t slots = 16;
+        while (slots < size) {
+            slots *= 2;
+        }
+        vector<uint64_t> keys(slots, kEmpty);
+        vector<uint32_t> values(slots);
+        m_mask = slots - 1;
+        for (size_t i = 0; i < m_keys.size(); ++i) {
+            if (m_keys[i] != kEmpty) {
+                size_t slot = slotOf(m_keys[i]);
+                while (keys[slot] != kEmpty) {
+                    slot = (slot + 1) & m_mask;
+                }
+                keys[slot] = m_keys[i];
+                values[slot] = m_values[i];
+            }
+        }
+        m_keys.swap(keys);
+        m_values.swap(values);
+    }
+
+    vector<uint64_t> m_keys;
+    vector<uint32_t> m_values;
+    size_t m_mask = 0;
+    size_t m_size = 0;
+};
+
+} // namespace
+
+size_t IndexedMesh::memoryBytes() const {
+    return positions.capacity() * sizeof(Vector3f) +
+           normals.capacity() * sizeof(Vector3f) +
+           indices.capacity() * sizeof(uint32_t);
+}
+
+MeshView IndexedMesh::view() const {
+    MeshView view;
+    view.positions = positions.data();
+    view.normals = normals.data();
+    view.vertexCount = positions.size();
+    view.indices = indices.data();
+    view.indexCount = indices.size();
+    return view;
+}
+
+IndexedMesh weldMesh(const ObjData &obj) {
+    IndexedMesh mesh;
+    size_t faceCount = obj.faceCount();
+    mesh.indices.reserve(3 * faceCount);
+
+    // smooth meshes have about one vertex per position; the map grows for
+    // the others
+    CornerMap map(obj.vecv.size());
+    size_t vCount = obj.vecv.size();
+    size_t nCount = obj.vecn.size();
+
+    for (size_t k = 0; k < faceCount; ++k) {
+        const uint32_t *face = &obj.vecf[6 * k];
+        bool inRange = true;
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t a = face[2 * corner];
+            uint32_t c = face[2 * corner + 1];
+            inRange = inRange && a >= 1 && a <= vCount && c >= 1 &&
+                      c <= nCount;
+        }
+        if (!inRange) {
+            continue;
+        }
+
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t a = face[2 * corner];
+            uint32_t c = face[2 * corner + 1];
+            bool inserted;
+            auto next = static_cast<uint32_t>(mesh.positions.size());
+            uint32_t vertex =
+                map.find(uint64_t(a) << 32 | c, next, inserted);
+            if (inserted) {
+                mesh.positions.push_back(obj.vecv[a - 1]);
+                mesh.normals.push_back(obj.vecn[c - 1]);
+            }
+            mesh.indices.push_back(vertex);
+        }
+    }
+
+    mesh.positions.shrink_to_fit();
+    mesh.normals.shrink_to_fit();
+    return mesh;
+}
+
+void normalizeNormals(IndexedMesh &mesh) {
+    vector<Vector3f> &normals = mesh.normals;
+    vector<bool> isZero(normals.size(), false);
+    bool anyZero = false;
+    for (size_t v = 0; v < normals.size(); ++v) {
+        if (normals[v].absSquared() == 0) {
+            isZero[v] = true;
+            anyZero = true;
+        }
+    }
+
+    Vec3View view(normals.data(), normals.size());
+    normalize(view, view);
+    if (!anyZero) {
+        return;
+    }
+
+    // the zero ones came out NaN: sum the normals of their triangles, each
+    // as long as twice its area, instead
+    for (size_t v = 0; v < normals.size(); ++v) {
+        if (isZero[v]) {
+            normals[v] = Vector3f(0);
+        }
+    }
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        const uint32_t *tri = &mesh.indices[i];
+        if (!isZero[tri[0]] && !isZero[tri[1]] && !isZero[tri[2]]) {
+            continue;
+        }
+        const Vector3f &p0 = mesh.positions[tri[0]];
+        Vector3f n = Vector3f::cross(mesh.positions[tri[1]] - p0,
+                                     mesh.positions[tri[2]] - p0);
+        for (int corner = 0; corner < 3; ++corner) {
+            if (isZero[tri[corner]]) {
+                normals[tri[corner]] += n;
+            }
+        }
+    }
+    for (size_t v = 0; v < normals.size(); ++v) {
+        if (isZero[v] && normals[v].absSquared() > 0) {
+            normals[v].normalize();
+        }
+    }
+}
+
+void optimizeMesh(IndexedMesh &mesh) {
+    size_t vertexCount = mesh.positions.size();
+    optimizeVertexCache(mesh.indices.data(), mesh.indices.data(),
+                        mesh.indices.size(), vertexCount);
+
+    vector<uint32_t> remap(vertexCount);
+    size_t used = optimizeVertexFetch(mesh.indices.data(), mesh.indices.size(),
+                                      vertexCount, remap.data());
+    vector<Vector3f> moved(used);
+    remapVertices(mesh.positions.data(), moved.data(), vertexCount,
+                  remap.data());
+    mesh.positions.swap(moved);
+    moved.assign(used, Vector3f());
+    remapVertices(mesh.normals.data(), moved.data(), vertexCount,
+                  remap.data());
+    mesh.normals.swap(moved);
+}
+
+void writeObj(ostream &out, const MeshView &mesh) {
+    vector<uint32_t> indices(mesh.indices, mesh.indices + mesh.indexCount);
+    vector<uint32_t> remap(mesh.vertexCount);
+    size_t used = optimizeVertexFetch(indices.data(), indices.size(),
+                                      mesh.vertexCount, remap.data());
+    vector<uint32_t> order(used);
+    for (size_t v = 0; v < mesh.vertexCount; ++v) {
+        if (remap[v] != UNUSED_VERTEX) {
+            order[remap[v]] = static_cast<uint32_t>(v);
+        }
+    }
+
+    // enough digits to read back the same floats
+    auto precision = out.precision(numeric_limits<float>::max_digits10);
+    for (uint32_t v : order) {
+        const Vector3f &p = mesh.positions[v];
+        out << "v " << p[0] << " " << p[1] << " " << p[2] << "\n";
+    }
+    for (uint32_t v : order) {
+        const Vector3f &n = mesh.normals[v];
+        out << "vn " << n[0] << " " << n[1] << " " << n[2] << "\n";
+    }
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        out << "f";
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t a = indices[i + corner] + 1;
+            out << " " << a << "//" << a;
+        }
+        out << "\n";
+    }
+    out.precision(precision);
+}
+
+VertexCacheStats analyzeMesh(const MeshView &mesh, unsigned cacheSize) {
+    return analyzeVertexCache(mesh.indices, mesh.indexCount, mesh.vertexCount,
+                              cacheSize);
+}
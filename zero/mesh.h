@@ -0,0 +1,60 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include "objload.h"
+
+#include <vecmath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// An IndexedMesh, as a0 draws it, in arrays that belong to something else,
+// such as a mapped MeshCache
+struct MeshView {
+    const Vector3f *positions = nullptr;
+    const Vector3f *normals = nullptr;
+    size_t vertexCount = 0;
+    const uint32_t *indices = nullptr; // 3 per triangle
+    size_t indexCount = 0;
+};
+
+// An indexed triangle mesh, ready for glDrawElements: one vertex, with its
+// position and normal, per distinct (position, normal) pair the faces use,
+// and three 0-based vertex indices per triangle.
+struct IndexedMesh {
+    std::vector<Vector3f> positions;
+    std::vector<Vector3f> normals;
+    std::vector<uint32_t> indices;
+
+    // the bytes its arrays take
+    size_t memoryBytes() const;
+
+    MeshView view() const;
+};
+
+// Welds obj's faces into an IndexedMesh: each (position index, normal index)
+// pair becomes one vertex, numbered in order of first use.  Faces with an
+// index out of range are dropped.
+IndexedMesh weldMesh(const ObjData &obj);
+
+// Scales mesh's normals to unit length, as the lighting assumes.  A zero
+// normal has no direction to keep, so its vertex gets the area-weighted
+// normal of the triangles around it instead, or stays zero if those are
+// degenerate too.
+void normalizeNormals(IndexedMesh &mesh);
+
+// Reorders mesh's triangles for the GPU's post-transform vertex cache, then
+// renumbers its vertices in the order the triangles use them (see
+// VertexCache.h).  The mesh looks the same.
+void optimizeMesh(IndexedMesh &mesh);
+
+// Writes mesh as an OBJ file: the vertices its triangles use, in the order
+// they use them, and the triangles as "f a//a b//b c//c"
+void writeObj(std::ostream &out, const MeshView &mesh);
+
+// analyzeVertexCache of mesh's triangles, for a cache of cacheSize vertices
+VertexCacheStats analyzeMesh(const MeshView &mesh, unsigned cacheSize = 16);
+
+#endif
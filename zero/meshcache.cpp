@@ -0,0 +1,259 @@
+#include "meshcache.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+const char kMagic[8] = {'a', '0', 'm', 'e', 's', 'h', '\r', '\n'};
+// 1: per face six OBJ indices; 2: welded vertices and three indices;
+// 3: the same in vertex cache order; 4: levels of detail
+const uint32_t kVersion = 4;
+const uint32_t kByteOrder = 0x01020304;
+const size_t kArrayAlignment = 64;
+// positions, normals, indices and those of each level of detail
+const size_t kArrays = 3 + kMaxLods;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder; // kByteOrder as written
+    uint64_t sourceSize;
+    int64_t sourceMtime; // in nanoseconds
+    uint64_t sourceHash;
+    // the element count and the byte offset from the start of the file of
+    // each array; those of missing levels are empty
+    uint64_t count[kArrays];
+    uint64_t offset[kArrays];
+    uint32_t lodCount;
+    float lodError[kMaxLods];
+};
+
+inline size_t elementSize(size_t array) {
+    return array < 2 ? sizeof(Vector3f) : sizeof(uint32_t);
+}
+
+static_assert(sizeof(Vector3f) == 3 * sizeof(float),
+              "the cache stores Vector3f arrays as packed floats");
+
+inline uint64_t alignUp(uint64_t n) {
+    return (n + kArrayAlignment - 1) / kArrayAlignment * kArrayAlignment;
+}
+
+inline int64_t mtimeOf(const struct stat &st) {
+    return int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+// Whether the count indices at p are whole triangles of vertices below
+// vertexCount
+bool validTriangles(const uint32_t *p, uint64_t count, uint64_t vertexCount) {
+    if (count % 3 != 0) {
+        return false;
+    }
+    uint32_t largest = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        largest = max(largest, p[i]);
+    }
+    return count == 0 || largest < vertexCount;
+}
+
+bool writeAll(int fd, const void *data, size_t size) {
+    auto p = static_cast<const char *>(data);
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+} // namespace
+
+MeshCache::MeshCache(const char *path, int sourceFd) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    m_file.reset(new FileContents(fd));
+    close(fd);
+
+    const char *data = m_file->data();
+    size_t size = m_file->size();
+    if (!m_file->ok() || size < sizeof(CacheHeader)) {
+        return;
+    }
+    CacheHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion || header.byteOrder != kByteOrder) {
+        return;
+    }
+    if (header.count[0] != header.count[1] || header.lodCount > kMaxLods) {
+        return;
+    }
+    for (size_t i = 0; i < kArrays; ++i) {
+        if (header.offset[i] % kArrayAlignment != 0 ||
+            header.offset[i] > size ||
+            header.count[i] > (size - header.offset[i]) / elementSize(i)) {
+            return;
+        }
+    }
+
+    // is it still the source's?
+    struct stat st;
+    if (fstat(sourceFd, &st) != 0 ||
+        uint64_t(st.st_size) != header.sourceSize) {
+        return;
+    }
+    if (mtimeOf(st) != header.sourceMtime) {
+        // touched or copied, but perhaps the same bytes
+        FileContents source(sourceFd);
+        if (!source.ok() ||
+            hashBytes(source.data(), source.size()) != header.sourceHash) {
+            return;
+        }
+        m_sourceTouched = true;
+    }
+
+    // a corrupt cache must not send a draw past the vertex arrays; the
+    // index arrays follow each other, so this reads them in file order
+    auto array = [&](int i) { return data + header.offset[i]; };
+    for (uint32_t i = 2; i < 3 + header.lodCount; ++i) {
+        if (!validTriangles(reinterpret_cast<const uint32_t *>(array(i)),
+                            header.count[i], header.count[0])) {
+            return;
+        }
+    }
+
+    m_view.positions = reinterpret_cast<const Vector3f *>(array(0));
+    m_view.normals = reinterpret_cast<const Vector3f *>(array(1));
+    m_view.vertexCount = header.count[0];
+    m_view.indices = reinterpret_cast<const uint32_t *>(array(2));
+    m_view.indexCount = header.count[2];
+    for (uint32_t level = 0; level < header.lodCount; ++level) {
+        MeshLodView lod;
+        lod.indices = reinterpret_cast<const uint32_t *>(array(3 + level));
+        lod.indexCount = header.count[3 + level];
+        lod.error = header.lodError[level];
+        m_lods.push_back(lod);
+    }
+    m_ok = true;
+}
+
+bool writeMeshCache(const char *path, const MeshView &mesh,
+                    const vector<MeshLodView> &lods, int sourceFd,
+                    const char *source, size_t size) {
+    struct stat st;
+    if (lods.size() > kMaxLods || fstat(sourceFd, &st) != 0) {
+        return false;
+    }
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrder;
+    header.sourceSize = size;
+    header.sourceMtime = mtimeOf(st);
+    header.sourceHash = hashBytes(source, size);
+
+    const void *arrays[kArrays] = {mesh.positions, mesh.normals,
+                                   mesh.indices};
+    header.count[0] = mesh.vertexCount;
+    header.count[1] = mesh.vertexCount;
+    header.count[2] = mesh.indexCount;
+    header.lodCount = static_cast<uint32_t>(lods.size());
+    for (size_t level = 0; level < lods.size(); ++level) {
+        arrays[3 + level] = lods[level].indices;
+        header.count[3 + level] = lods[level].indexCount;
+        header.lodError[level] = lods[level].error;
+    }
+    uint64_t end = sizeof(header);
+    for (size_t i = 0; i < kArrays; ++i) {
+        header.offset[i] = alignUp(end);
+        end = header.offset[i] + header.count[i] * elementSize(i);
+    }
+
+    // written beside the cache and renamed over it, so that a reader sees
+    // the old cache or the new one, never a mix
+    string temp = string(path) + "." + to_string(getpid());
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = writeAll(fd, &header, sizeof(header));
+    uint64_t written = sizeof(header);
+    const char zeros[kArrayAlignment] = {};
+    for (size_t i = 0; i < kArrays && ok; ++i) {
+        ok = writeAll(fd, zeros, header.offset[i] - written) &&
+             writeAll(fd, arrays[i], header.count[i] * elementSize(i));
+        written = header.offset[i] + header.count[i] * elementSize(i);
+    }
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(temp.c_str(), path) != 0) {
+        unlink(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool touchMeshCache(const char *path, int sourceFd) {
+    struct stat st;
+    if (fstat(sourceFd, &st) != 0) {
+        return false;
+    }
+    int64_t mtime = mtimeOf(st);
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = pwrite(fd, &mtime, sizeof(mtime),
+                     offsetof(CacheHeader, sourceMtime)) == sizeof(mtime);
+    return close(fd) == 0 && ok;
+}
+
+string meshCachePath(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return "";
+    }
+    char link[64];
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+    char path[PATH_MAX];
+    ssize_t n = readlink(link, path, sizeof(path) - 1);
+    if (n <= 0) {
+        return "";
+    }
+    return string(path, n) + ".a0mesh";
+}
+
+uint64_t hashBytes(const char *data, size_t size) {
+    const uint64_t prime = 0x100000001b3;
+    uint64_t hash = 0xcbf29ce484222325;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash;
+}
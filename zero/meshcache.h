@@ -0,0 +1,69 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include "mesh.h"
+#include "objload.h"
+#include "simplify.h"
+
+#include <vecmath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// the most levels of detail a cache holds
+const size_t kMaxLods = 8;
+
+// A binary copy of a mesh and its levels of detail that maps straight into
+// a MeshView and MeshLodViews, with nothing to parse or copy.  The file, in
+// native byte order, is a header, then the positions, normals and indices,
+// then the indices of each level, each array 64-byte aligned.  The header
+// records a format version and the size, modification time and hash of the
+// OBJ file the mesh came from: the cache is used if the size matches and
+// either the time or, failing that, the hash does.  It is also rejected
+// unless its index arrays are whole triangles of its vertices.
+class MeshCache {
+  public:
+    // Maps the cache at path, checking it against the source open on
+    // sourceFd; check ok()
+    MeshCache(const char *path, int sourceFd);
+
+    bool ok() const { return m_ok; }
+    // Whether the source's modification time differs from the one recorded
+    // although its bytes match, in which case touchMeshCache saves hashing
+    // it again next time
+    bool sourceTouched() const { return m_sourceTouched; }
+    const MeshView &view() const { return m_view; }
+    const std::vector<MeshLodView> &lods() const { return m_lods; }
+
+  private:
+    std::unique_ptr<FileContents> m_file;
+    MeshView m_view;
+    std::vector<MeshLodView> m_lods;
+    bool m_ok = false;
+    bool m_sourceTouched = false;
+};
+
+// Writes mesh and up to kMaxLods lods of it to path as the cache of the
+// source open on sourceFd, whose bytes are [source, source + size).
+// Returns false if it can't; a cache half-written when that happens is
+// never seen.
+bool writeMeshCache(const char *path, const MeshView &mesh,
+                    const std::vector<MeshLodView> &lods, int sourceFd,
+                    const char *source, size_t size);
+
+// Records the modification time of the source open on sourceFd in the
+// cache at path, in place; false if it can't
+bool touchMeshCache(const char *path, int sourceFd);
+
+// Where the cache of the file open on fd goes: its path plus ".a0mesh", or
+// "" if fd isn't a regular file with a path (e.g. a pipe)
+std::string meshCachePath(int fd);
+
+// The hash the cache keeps of its source: 64-bit FNV-1a, taken 8 bytes at
+// a time
+uint64_t hashBytes(const char *data, size_t size);
+
+#endif
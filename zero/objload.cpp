@@ -0,0 +1,348 @@
+#include "objload.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+using namespace std;
+
+FileContents::FileContents(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        m_size = st.st_size;
+        if (m_size == 0) {
+            m_ok = true;
+            return;
+        }
+        void *p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            // one sequential pass
+            madvise(p, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const char *>(p);
+            m_mapped = true;
+            m_ok = true;
+            return;
+        }
+    }
+
+    // not mappable: read it all
+    char chunk[1 << 16];
+    for (;;) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return;
+        }
+        if (n == 0) {
+            break;
+        }
+        m_buffer.insert(m_buffer.end(), chunk, chunk + n);
+    }
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    m_ok = true;
+}
+
+FileContents::~FileContents() {
+    if (m_mapped) {
+        munmap(const_cast<char *>(m_data), m_size);
+    }
+}
+
+namespace {
+
+// The characters an istream skips between words, but for the newline, which
+// ends the line first
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char *skipSpace(const char *p, const char *end) {
+    while (p != end && isSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Powers of ten that are exact floats
+constexpr float kPow10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                            1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+// Parses the decimal float at p into value and returns its end, or returns
+// p if there is none.  What exporters write, a short mantissa and a small
+// exponent, takes Clinger's fast path: the digits and the power of ten are
+// both exact floats, so one multiply or divide rounds the value correctly.
+// Anything longer goes to std::from_chars, which also rounds correctly, so
+// every value matches operator>>'s.
+const char *parseFloat(const char *p, const char *end, float &value) {
+    const char *start = p;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;   // significant digits in mantissa
+    int exponent = 0; // of ten
+    bool any = false;
+    for (; p != end && isDigit(*p); ++p, any = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        } else {
+            ++exponent;
+            ++digits;
+        }
+    }
+    if (p != end && *p == '.') {
+        for (++p; p != end && isDigit(*p); ++p, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                --exponent;
+            } else {
+                ++digits;
+            }
+        }
+    }
+    if (!any) {
+        return start;
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool negativeExponent = false;
+        if (q != end && (*q == '-' || *q == '+')) {
+            negativeExponent = *q == '-';
+            ++q;
+        }
+        if (q != end && isDigit(*q)) {
+            int e = 0;
+            for (; q != end && isDigit(*q); ++q) {
+                e = min(e * 10 + (*q - '0'), 100000);
+            }
+            exponent += negativeExponent ? -e : e;
+            p = q;
+        }
+    }
+
+    if (mantissa <= (1u << 24) && exponent >= -10 && exponent <= 10) {
+        float f = static_cast<float>(mantissa);
+        f = exponent < 0 ? f / kPow10[-exponent] : f * kPow10[exponent];
+        value = negative ? -f : f;
+        return p;
+    }
+
+    // from_chars takes no '+'; it stops where the scan above did
+    const char *q = *start == '+' ? start + 1 : start;
+    auto result = from_chars(q, p, value);
+    if (result.ec == errc::result_out_of_range) {
+        // as operator>>: overflow saturates, underflow goes to zero
+        value = exponent > 0 ? numeric_limits<float>::max() : 0.f;
+        value = negative ? -value : value;
+    }
+    return p;
+}
+
+// Parses the decimal integer at p into value, as "%d" would for what OBJ
+// files hold, and returns its end, or returns p if there is none
+inline const char *parseIndex(const char *p, const char *end, long &value) {
+    const char *start = p;
+    bool negative = p != end && *p == '-';
+    p += negative;
+    long v = 0;
+    const char *digits = p;
+    for (; p != end && isDigit(*p); ++p) {
+        v = v * 10 + (*p - '0');
+    }
+    if (p == digits) {
+        return start;
+    }
+    value = negative ? -v : v;
+    return p;
+}
+
+// Parses "x y z" after a "v" or "vn"; a missing or malformed number reads
+// as 0, as do the ones after it
+inline Vector3f parseVector(const char *p, const char *end) {
+    float xyz[3] = {0, 0, 0};
+    for (float &c : xyz) {
+        p = skipSpace(p, end);
+        const char *q = parseFloat(p, end, c);
+        if (q == p) {
+            break;
+        }
+        p = q;
+    }
+    return Vector3f(xyz[0], xyz[1], xyz[2]);
+}
+
+// Resolves the OBJ index i against the count elements read so far: positive
+// indices count from 1, and negative ones back from the last element, which
+// makes the result relative
+inline unsigned resolveIndex(long i, size_t count, bool &relative) {
+    relative = i < 0;
+    return relative ? static_cast<unsigned>(count + 1 + i)
+                    : static_cast<unsigned>(i);
+}
+
+// Parses one "a/b/c" face corner into its position index a and normal
+// index c; b may be left out ("a//c")
+inline const char *parseCorner(const char *p, const char *end, long &a,
+                               long &c) {
+    p = skipSpace(p, end);
+    p = parseIndex(p, end, a);
+    if (p != end && *p == '/') {
+        long b;
+        p = parseIndex(p + 1, end, b);
+        if (p != end && *p == '/') {
+            p = parseIndex(p + 1, end, c);
+        }
+    }
+    // skip whatever else the word holds
+    while (p != end && !isSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// parseObj, recording in relative (when it isn't null) where in vecf each
+// index resolved from a negative one is
+void parseObjLines(const char *begin, const char *end, ObjData &obj,
+                   vector<size_t> *relative) {
+    const char *line = begin;
+    while (line != end) {
+        auto newline =
+            static_cast<const char *>(memchr(line, '\n', end - line));
+        const char *lineEnd = newline ? newline : end;
+
+        const char *p = skipSpace(line, lineEnd);
+        const char *type = p;
+        while (p != lineEnd && !isSpace(*p)) {
+            ++p;
+        }
+        size_t typeLength = p - type;
+
+        if (typeLength == 1 && type[0] == 'v') {
+            obj.vecv.push_back(parseVector(p, lineEnd));
+        } else if (typeLength == 2 && type[0] == 'v' && type[1] == 'n') {
+            obj.vecn.push_back(parseVector(p, lineEnd));
+        } else if (typeLength == 1 && type[0] == 'f') {
+            // a, c, d, f, g, i: positions at even slots, normals at odd
+            long index[6] = {0, 0, 0, 0, 0, 0};
+            for (int corner = 0; corner < 3; ++corner) {
+                p = parseCorner(p, lineEnd, index[2 * corner],
+                                index[2 * corner + 1]);
+            }
+
+            for (int slot = 0; slot < 6; ++slot) {
+                size_t count = slot % 2 ? obj.vecn.size() : obj.vecv.size();
+                bool isRelative;
+                obj.vecf.push_back(
+                    resolveIndex(index[slot], count, isRelative));
+                if (isRelative && relative) {
+                    relative->push_back(obj.vecf.size() - 1);
+                }
+            }
+        }
+
+        line = newline ? newline + 1 : end;
+    }
+}
+
+} // namespace
+
+void parseObj(const char *begin, const char *end, ObjData &obj) {
+    parseObjLines(begin, end, obj, nullptr);
+}
+
+void parseObj(const char *begin, const char *end, ObjData &obj,
+              unsigned threads) {
+    size_t size = end - begin;
+    if (threads == 0) {
+        // enough text per thread to repay starting it
+        const size_t minChunk = 1 << 20;
+        threads = max(1u, thread::hardware_concurrency());
+        threads = static_cast<unsigned>(min<size_t>(threads, size / minChunk));
+    }
+    if (threads <= 1) {
+        parseObj(begin, end, obj);
+        return;
+    }
+
+    // chunk k starts on the line after size * k / threads; a line split
+    // across two of them goes to the first
+    vector<const char *> bounds(threads + 1, end);
+    bounds[0] = begin;
+    for (unsigned k = 1; k < threads; ++k) {
+        const char *p = max(bounds[k - 1], begin + size * k / threads);
+        if (p != begin && p[-1] != '\n') {
+            auto newline =
+                static_cast<const char *>(memchr(p, '\n', end - p));
+            p = newline ? newline + 1 : end;
+        }
+        bounds[k] = p;
+    }
+
+    vector<ObjData> chunks(threads);
+    vector<vector<size_t>> relative(threads);
+    vector<thread> workers;
+    for (unsigned k = 1; k < threads; ++k) {
+        workers.emplace_back(parseObjLines, bounds[k], bounds[k + 1],
+                             ref(chunks[k]), &relative[k]);
+    }
+    parseObjLines(bounds[0], bounds[1], chunks[0], &relative[0]);
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    size_t vCount = obj.vecv.size();
+    size_t nCount = obj.vecn.size();
+    size_t iCount = obj.vecf.size();
+    for (auto &chunk : chunks) {
+        vCount += chunk.vecv.size();
+        nCount += chunk.vecn.size();
+        iCount += chunk.vecf.size();
+    }
+    obj.vecv.reserve(vCount);
+    obj.vecn.reserve(nCount);
+    obj.vecf.reserve(iCount);
+
+    // Each chunk resolved its negative indices against its own counts; the
+    // elements before it, a prefix sum of the chunk sizes, move them up.
+    // Positive indices are global already.
+    for (unsigned k = 0; k < threads; ++k) {
+        auto &chunk = chunks[k];
+        auto vOffset = static_cast<unsigned>(obj.vecv.size());
+        auto nOffset = static_cast<unsigned>(obj.vecn.size());
+        for (size_t slot : relative[k]) {
+            // normal indices are at odd slots, as faces are 6 long
+            chunk.vecf[slot] += slot % 2 ? nOffset : vOffset;
+        }
+
+        obj.vecv.insert(obj.vecv.end(), chunk.vecv.begin(), chunk.vecv.end());
+        obj.vecn.insert(obj.vecn.end(), chunk.vecn.begin(), chunk.vecn.end());
+        obj.vecf.insert(obj.vecf.end(), chunk.vecf.begin(), chunk.vecf.end());
+    }
+}
+
+bool loadObj(int fd, ObjData &obj, unsigned threads) {
+    FileContents file(fd);
+    if (!file.ok()) {
+        return false;
+    }
+    parseObj(file.data(), file.data() + file.size(), obj, threads);
+    return true;
+}
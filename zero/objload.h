@@ -0,0 +1,63 @@
+#ifndef OBJLOAD_H
+#define OBJLOAD_H
+
+#include <vecmath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The subset of OBJ that a0 draws: "v" positions, "vn" normals, and the
+// first three corners of each "f" face.  Every face adds a, c, d, f, g, i
+// from "f a/b/c d/e/f g/h/i" to vecf: the 1-based position and normal index
+// of each corner.  Other lines are skipped.
+struct ObjData {
+    std::vector<Vector3f> vecv;
+    std::vector<Vector3f> vecn;
+    std::vector<uint32_t> vecf; // 6 per face
+
+    size_t faceCount() const { return vecf.size() / 6; }
+};
+
+// A file's bytes: memory-mapped read-only when it is a regular file, and
+// read into memory otherwise (e.g. a pipe on stdin).
+class FileContents {
+  public:
+    // Reads fd, which stays open and owned by the caller; check ok()
+    explicit FileContents(int fd);
+    ~FileContents();
+
+    FileContents(const FileContents &) = delete;
+    FileContents &operator=(const FileContents &) = delete;
+
+    bool ok() const { return m_ok; }
+    const char *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+  private:
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+    bool m_mapped = false;
+    bool m_ok = false;
+    std::vector<char> m_buffer;
+};
+
+// Parses the OBJ text [begin, end) in place, appending to obj.  Gives the
+// same data as reading the text line by line through an istream: numbers are
+// parsed without the locale, and floats round exactly as operator>> does.
+// Negative (relative) face indices count back from the last v or vn so far.
+void parseObj(const char *begin, const char *end, ObjData &obj);
+
+// parseObj split over threads workers, with exactly the same result.  The
+// text is cut at line boundaries into one chunk per worker, and the chunks
+// are merged in order; 0 threads means one per hardware thread, but none
+// for less than 1 MiB of text.
+void parseObj(const char *begin, const char *end, ObjData &obj,
+              unsigned threads);
+
+// Reads the OBJ file open on fd (such as stdin) into obj with parseObj,
+// mapping it when it can.  Returns false, leaving obj alone, if fd can't be
+// read.
+bool loadObj(int fd, ObjData &obj, unsigned threads = 1);
+
+#endif
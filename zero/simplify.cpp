@@ -0,0 +1,434 @@
+#include "simplify.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+// how much more a boundary edge's plane weighs than the faces beside it,
+// so that the outline of an open mesh keeps its shape
+const double kBoundaryWeight = 10;
+
+// The area-weighted sum of squared distances to a set of planes:
+// Q(p) = p^T A p + 2 b.p + c, A symmetric
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0; // the total area
+
+    Quadric() = default;
+
+    // the plane n.p + d = 0, with n of unit length, weighted by w
+    Quadric(const Vec3d &n, double d, double w)
+        : a00(w * n[0] * n[0]), a01(w * n[0] * n[1]), a02(w * n[0] * n[2]),
+          a11(w * n[1] * n[1]), a12(w * n[1] * n[2]), a22(w * n[2] * n[2]),
+          b0(w * n[0] * d), b1(w * n[1] * d), b2(w * n[2] * d),
+          c(w * d * d), weight(w) {}
+
+    Quadric &operator+=(const Quadric &q) {
+        a00 += q.a00, a01 += q.a01, a02 += q.a02;
+        a11 += q.a11, a12 += q.a12, a22 += q.a22;
+        b0 += q.b0, b1 += q.b1, b2 += q.b2;
+        c += q.c;
+        weight += q.weight;
+        return *this;
+    }
+
+    double operator()(const Vector3f &p) const {
+        double x = p[0], y = p[1], z = p[2];
+        double e = a00 * x * x + a11 * y * y + a22 * z * z +
+                   2 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                   2 * (b0 * x + b1 * y + b2 * z) + c;
+        // rounding can take it just below zero
+        return max(e, 0.);
+    }
+};
+
+// what may move
+enum VertexKind : uint8_t {
+    INTERIOR,
+    BOUNDARY, // on an edge of one triangle: moves only along such edges
+    LOCKED,   // on a normal seam or a non-manifold edge
+};
+
+// An edge as the pair of its vertices, the lower in the high half
+inline uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return a < b ? uint64_t(a) << 32 | b : uint64_t(b) << 32 | a;
+}
+
+// The triangles of each vertex: adjacency[first[v]] to adjacency[first[v +
+// 1]], by index into the triangle list
+struct Adjacency {
+    vector<size_t> first;
+    vector<uint32_t> adjacency;
+
+    Adjacency(const vector<uint32_t> &indices, size_t vertexCount)
+        : first(vertexCount + 1, 0), adjacency(indices.size()) {
+        for (uint32_t v : indices) {
+            ++first[v + 1];
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            first[v + 1] += first[v];
+        }
+        vector<size_t> fill(first.begin(), first.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    const uint32_t *begin(uint32_t v) const { return &adjacency[first[v]]; }
+    const uint32_t *end(uint32_t v) const {
+        return adjacency.data() + first[v + 1];
+    }
+};
+
+// One candidate collapse: from onto to, at error cost
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double cost;
+};
+
+class Simplifier {
+  public:
+    explicit Simplifier(const MeshView &mesh)
+        : m_mesh(mesh), m_indices(mesh.indices, mesh.indices + mesh.indexCount),
+          m_quadrics(mesh.vertexCount), m_seam(mesh.vertexCount, false),
+          m_remap(mesh.vertexCount), m_touched(mesh.vertexCount, false) {
+        addFaceQuadrics();
+        addBoundaryQuadrics();
+        findSeams();
+        for (size_t v = 0; v < m_remap.size(); ++v) {
+            m_remap[v] = static_cast<uint32_t>(v);
+        }
+    }
+
+    size_t triangleCount() const { return m_indices.size() / 3; }
+    const vector<uint32_t> &indices() const { return m_indices; }
+    float error() const { return static_cast<float>(m_error); }
+
+    // One round of collapses, cheapest first, each touching triangles no
+    // other collapse of the round has changed, until at most target
+    // triangles are left; false if none could go
+    bool pass(size_t target);
+
+  private:
+    Vector3f position(uint32_t v) const { return m_mesh.positions[v]; }
+
+    void findSeams();
+    void addFaceQuadrics();
+    void addBoundaryQuadrics();
+
+    bool flips(uint32_t from, uint32_t to, const Adjacency &adjacency) const;
+    bool pinches(uint32_t from, uint32_t to, const Adjacency &adjacency,
+                 bool boundaryEdge) const;
+
+    const MeshView &m_mesh;
+    vector<uint32_t> m_indices;
+    vector<Quadric> m_quadrics;
+    vector<bool> m_seam; // see findSeams
+    // per pass: the vertex each collapsed into, and those whose triangles
+    // changed, which can't move again until the next
+    vector<uint32_t> m_remap;
+    vector<bool> m_touched;
+    double m_error = 0;
+};
+
+// The two sides of a normal seam are welded into different vertices at the
+// same position, so the edges along it look like boundary: a boundary vertex
+// with a twin is on a seam.  (A twin alone is not enough: torus.obj is two
+// coincident closed tori.)
+void Simplifier::findSeams() {
+    vector<uint32_t> order;
+    for (size_t v = 0; v < m_seam.size(); ++v) {
+        if (m_seam[v]) {
+            order.push_back(static_cast<uint32_t>(v));
+        }
+    }
+    fill(m_seam.begin(), m_seam.end(), false);
+    auto bits = [&](uint32_t v) {
+        array<uint32_t, 3> key;
+        memcpy(key.data(), &m_mesh.positions[v], sizeof(key));
+        return key;
+    };
+    sort(order.begin(), order.end(),
+         [&](uint32_t a, uint32_t b) { return bits(a) < bits(b); });
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (bits(order[i - 1]) == bits(order[i])) {
+            m_seam[order[i - 1]] = m_seam[order[i]] = true;
+        }
+    }
+}
+
+void Simplifier::addFaceQuadrics() {
+    for (size_t i = 0; i < m_indices.size(); i += 3) {
+        Vec3d p0 = toVec<double>(position(m_indices[i]));
+        Vec3d p1 = toVec<double>(position(m_indices[i + 1]));
+        Vec3d p2 = toVec<double>(position(m_indices[i + 2]));
+        Vec3d n = Vec3d::cross(p1 - p0, p2 - p0);
+        double length = n.abs();
+        if (length == 0) {
+            continue;
+        }
+        n = n / length;
+        Quadric q(n, -Vec3d::dot(n, p0), length / 2);
+        for (int corner = 0; corner < 3; ++corner) {
+            m_quadrics[m_indices[i + corner]] += q;
+        }
+    }
+}
+
+void Simplifier::addBoundaryQuadrics() {
+    // an edge is on the boundary if one triangle has it
+    vector<uint64_t> edges;
+    edges.reserve(m_indices.size());
+    for (size_t i = 0; i < m_indices.size(); i += 3) {
+        for (int corner = 0; corner < 3; ++corner) {
+            edges.push_back(edgeKey(m_indices[i + corner],
+                                    m_indices[i + (corner + 1) % 3]));
+        }
+    }
+    sort(edges.begin(), edges.end());
+
+    for (size_t i = 0; i < m_indices.size(); i += 3) {
+        Vec3d p[3];
+        for (int corner = 0; corner < 3; ++corner) {
+            p[corner] = toVec<double>(position(m_indices[i + corner]));
+        }
+        Vec3d n = Vec3d::cross(p[1] - p[0], p[2] - p[0]);
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t a = m_indices[i + corner];
+            uint32_t b = m_indices[i + (corner + 1) % 3];
+            auto range = equal_range(edges.begin(), edges.end(), edgeKey(a, b));
+            if (range.second - range.first != 1) {
+                continue;
+            }
+            m_seam[a] = m_seam[b] = true; // for findSeams
+
+            // the plane through the edge, perpendicular to the face
+            Vec3d e = p[(corner + 1) % 3] - p[corner];
+            Vec3d m = Vec3d::cross(e, n);
+            double length = m.abs();
+            if (length == 0) {
+                continue;
+            }
+            m = m / length;
+            Quadric q(m, -Vec3d::dot(m, p[corner]),
+                      kBoundaryWeight * e.absSquared());
+            m_quadrics[a] += q;
+            m_quadrics[b] += q;
+        }
+    }
+}
+
+// Whether moving from onto to turns a triangle of from's over, or makes it
+// degenerate
+bool Simplifier::flips(uint32_t from, uint32_t to,
+                       const Adjacency &adjacency) const {
+    for (auto t = adjacency.begin(from); t != adjacency.end(from); ++t) {
+        const uint32_t *tri = &m_indices[3 * size_t(*t)];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            continue; // collapses away
+        }
+        Vector3f p[3], moved[3];
+        for (int corner = 0; corner < 3; ++corner) {
+            p[corner] = position(tri[corner]);
+            moved[corner] = tri[corner] == from ? position(to) : p[corner];
+        }
+        Vector3f n0 = Vector3f::cross(p[1] - p[0], p[2] - p[0]);
+        Vector3f n1 =
+            Vector3f::cross(moved[1] - moved[0], moved[2] - moved[0]);
+        if (Vector3f::dot(n0, n1) <= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Whether from and to share more neighbours than the triangles on their
+// edge do, so that the collapse would glue two sheets of surface together
+// (the link condition)
+bool Simplifier::pinches(uint32_t from, uint32_t to,
+                         const Adjacency &adjacency,
+                         bool boundaryEdge) const {
+    uint32_t near[64];
+    size_t nearCount = 0;
+    for (auto t = adjacency.begin(from); t != adjacency.end(from); ++t) {
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t v = m_indices[3 * size_t(*t) + corner];
+            if (v != from && v != to &&
+                find(near, near + nearCount, v) == near + nearCount) {
+                if (nearCount == 64) {
+                    return true; // too busy a vertex to bother with
+                }
+                near[nearCount++] = v;
+            }
+        }
+    }
+    size_t shared = 0;
+    for (auto t = adjacency.begin(to); t != adjacency.end(to); ++t) {
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t v = m_indices[3 * size_t(*t) + corner];
+            auto found = find(near, near + nearCount, v);
+            if (found != near + nearCount) {
+                *found = near[--nearCount]; // count each once
+                ++shared;
+            }
+        }
+    }
+    return shared > (boundaryEdge ? 1u : 2u);
+}
+
+bool Simplifier::pass(size_t target) {
+    size_t vertexCount = m_remap.size();
+    Adjacency adjacency(m_indices, vertexCount);
+
+    // the edges, each once, with how many triangles have it
+    vector<uint64_t> edges;
+    edges.reserve(m_indices.size());
+    for (size_t i = 0; i < m_indices.size(); i += 3) {
+        for (int corner = 0; corner < 3; ++corner) {
+            edges.push_back(edgeKey(m_indices[i + corner],
+                                    m_indices[i + (corner + 1) % 3]));
+        }
+    }
+    sort(edges.begin(), edges.end());
+
+    vector<VertexKind> kind(vertexCount, INTERIOR);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (m_seam[v]) {
+            kind[v] = LOCKED;
+        }
+    }
+    vector<pair<uint64_t, bool>> unique; // and whether on the boundary
+    for (size_t i = 0; i < edges.size();) {
+        size_t j = i;
+        while (j < edges.size() && edges[j] == edges[i]) {
+            ++j;
+        }
+        auto a = static_cast<uint32_t>(edges[i] >> 32);
+        auto b = static_cast<uint32_t>(edges[i]);
+        if (j - i > 2) {
+            kind[a] = kind[b] = LOCKED;
+        } else if (j - i == 1) {
+            for (uint32_t v : {a, b}) {
+                kind[v] = max(kind[v], BOUNDARY);
+            }
+        }
+        unique.push_back({edges[i], j - i == 1});
+        i = j;
+    }
+
+    // each edge's cheaper direction that may go
+    vector<Collapse> collapses;
+    collapses.reserve(unique.size());
+    for (auto &edge : unique) {
+        auto a = static_cast<uint32_t>(edge.first >> 32);
+        auto b = static_cast<uint32_t>(edge.first);
+        auto mayMove = [&](uint32_t from) {
+            return kind[from] == INTERIOR ||
+                   (kind[from] == BOUNDARY && edge.second);
+        };
+        Quadric q = m_quadrics[a];
+        q += m_quadrics[b];
+        Collapse best = {0, 0, HUGE_VAL};
+        if (mayMove(a)) {
+            best = {a, b, q(position(b))};
+        }
+        if (mayMove(b) && q(position(a)) < best.cost) {
+            best = {b, a, q(position(a))};
+        }
+        if (best.cost != HUGE_VAL) {
+            // normalized to a squared distance
+            best.cost /= max(q.weight, 1e-30);
+            collapses.push_back(best);
+        }
+    }
+    sort(collapses.begin(), collapses.end(),
+         [](const Collapse &lhs, const Collapse &rhs) {
+             return lhs.cost < rhs.cost;
+         });
+
+    size_t triangles = triangleCount();
+    bool collapsed = false;
+    fill(m_touched.begin(), m_touched.end(), false);
+    for (const Collapse &c : collapses) {
+        if (triangles <= target) {
+            break;
+        }
+        if (m_touched[c.from] || m_touched[c.to]) {
+            continue;
+        }
+        bool boundaryEdge = kind[c.from] == BOUNDARY;
+        if (flips(c.from, c.to, adjacency) ||
+            pinches(c.from, c.to, adjacency, boundaryEdge)) {
+            continue;
+        }
+
+        for (auto t = adjacency.begin(c.from); t != adjacency.end(c.from);
+             ++t) {
+            const uint32_t *tri = &m_indices[3 * size_t(*t)];
+            for (int corner = 0; corner < 3; ++corner) {
+                m_touched[tri[corner]] = true;
+            }
+            if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+                --triangles;
+            }
+        }
+        m_remap[c.from] = c.to;
+        m_quadrics[c.to] += m_quadrics[c.from];
+        m_error = max(m_error, sqrt(c.cost));
+        collapsed = true;
+    }
+
+    // the triangles that are left, renumbered
+    size_t kept = 0;
+    for (size_t i = 0; i < m_indices.size(); i += 3) {
+        uint32_t a = m_remap[m_indices[i]];
+        uint32_t b = m_remap[m_indices[i + 1]];
+        uint32_t c = m_remap[m_indices[i + 2]];
+        if (a != b && b != c && c != a) {
+            m_indices[kept++] = a;
+            m_indices[kept++] = b;
+            m_indices[kept++] = c;
+        }
+    }
+    m_indices.resize(kept);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        m_remap[v] = static_cast<uint32_t>(v);
+    }
+    return collapsed;
+}
+
+} // namespace
+
+MeshLodView MeshLod::view() const {
+    MeshLodView view;
+    view.indices = indices.data();
+    view.indexCount = indices.size();
+    view.error = error;
+    return view;
+}
+
+vector<MeshLod> simplifyMesh(const MeshView &mesh,
+                             const vector<size_t> &targets) {
+    Simplifier simplifier(mesh);
+    vector<MeshLod> lods;
+    for (size_t target : targets) {
+        while (simplifier.triangleCount() > target &&
+               simplifier.pass(target)) {
+        }
+        MeshLod lod;
+        lod.indices = simplifier.indices();
+        lod.error = simplifier.error();
+        optimizeVertexCache(lod.indices.data(), lod.indices.data(),
+                            lod.indices.size(), mesh.vertexCount);
+        lods.push_back(move(lod));
+    }
+    return lods;
+}
@@ -0,0 +1,41 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A MeshLod in an array that belongs to something else, such as a mapped
+// MeshCache
+struct MeshLodView {
+    const uint32_t *indices = nullptr;
+    size_t indexCount = 0;
+    float error = 0;
+};
+
+// A coarser version of a mesh: its own triangles over the mesh's vertices
+struct MeshLod {
+    std::vector<uint32_t> indices; // 3 per triangle
+    // How far, in model units, the surface may have moved: the largest
+    // collapse error (root mean square distance to the planes of the
+    // original triangles around the vertex) taken to get here
+    float error = 0;
+
+    MeshLodView view() const;
+};
+
+// Simplifies mesh by edge collapses in order of quadric error (Garland and
+// Heckbert, "Surface Simplification Using Quadric Error Metrics", SIGGRAPH
+// 1997), once for each of targets (triangle counts, largest first), each
+// level carrying on from the one before.  A collapse moves a vertex onto a
+// neighbour, so every level indexes mesh's own vertex arrays; its triangles
+// are in vertex cache order.  Vertices on a normal seam stay put, boundary
+// vertices move only along the boundary, and collapses that would flip a
+// triangle or pinch the surface are skipped, so a level can keep more
+// triangles than asked for.
+std::vector<MeshLod> simplifyMesh(const MeshView &mesh,
+                                  const std::vector<size_t> &targets);
+
+#endif